@@ -10,6 +10,8 @@
 
 #ifdef _WIN32
 
+#include "dynamic_library.h"
+
 #include <cwchar>
 #include <Windows.h>
 
@@ -153,6 +155,11 @@ namespace fs
 	{
 	}
 
+	bool file_base::read_at(u64 offset, void* buffer, u64 size, u64& result)
+	{
+		return false;
+	}
+
 	dir_base::~dir_base()
 	{
 	}
@@ -882,6 +889,15 @@ fs::file::file(const std::string& path, bs_t<open_mode> mode)
 			return result;
 		}
 
+		bool read_at(u64 offset, void* buffer, u64 count, u64& result) override
+		{
+			const auto read = ::pread(m_fd, buffer, count, offset);
+			verify("file::read_at" HERE), read != -1;
+
+			result = read;
+			return true;
+		}
+
 		u64 write(const void* buffer, u64 count) override
 		{
 			const auto result = ::write(m_fd, buffer, count);
@@ -982,6 +998,215 @@ fs::file::file(const void* ptr, std::size_t size)
 	m_file = std::make_unique<memory_stream>(ptr, size);
 }
 
+fs::file::file(const std::shared_ptr<const file_map>& map)
+{
+	// Read-ahead window hinted for sequential reads
+	static constexpr u64 readahead_size = 0x100000;
+
+	class mapped_stream final : public file_base
+	{
+		const std::shared_ptr<const file_map> m_map;
+
+		u64 m_pos = 0;
+		u64 m_next = 0; // Position of the next sequential read
+		u64 m_advised = 0; // End of the range already hinted
+
+	public:
+		mapped_stream(const std::shared_ptr<const file_map>& map)
+			: m_map(map)
+		{
+		}
+
+		fs::stat_t stat() override
+		{
+			return m_map->info();
+		}
+
+		bool trunc(u64 length) override
+		{
+			return false;
+		}
+
+		u64 read(void* buffer, u64 count) override
+		{
+			const u64 size = m_map->size();
+
+			if (m_pos >= size)
+			{
+				return 0;
+			}
+
+			const u64 result = std::min<u64>(count, size - m_pos);
+
+			if (m_pos == m_next && m_pos + result + readahead_size / 2 > m_advised)
+			{
+				// Sequential stream: hint the following data
+				const u64 start = std::max<u64>(m_advised, m_pos);
+				m_advised = m_pos + result + readahead_size;
+				m_map->advise(start, m_advised - start);
+			}
+
+			std::memcpy(buffer, m_map->data() + m_pos, result);
+			m_pos += result;
+			m_next = m_pos;
+			return result;
+		}
+
+		bool read_at(u64 offset, void* buffer, u64 count, u64& result) override
+		{
+			const u64 size = m_map->size();
+
+			result = offset < size ? std::min<u64>(count, size - offset) : 0;
+			std::memcpy(buffer, m_map->data() + offset, result);
+			return true;
+		}
+
+		u64 write(const void* buffer, u64 count) override
+		{
+			return 0;
+		}
+
+		u64 seek(s64 offset, fs::seek_mode whence) override
+		{
+			return
+				whence == fs::seek_set ? m_pos = offset :
+				whence == fs::seek_cur ? m_pos = offset + m_pos :
+				whence == fs::seek_end ? m_pos = offset + m_map->size() :
+				(fmt::raw_error("fs::file::mapped_stream::seek(): invalid whence"), 0);
+		}
+
+		u64 size() override
+		{
+			return m_map->size();
+		}
+	};
+
+	if (map && *map)
+	{
+		m_file = std::make_unique<mapped_stream>(map);
+	}
+}
+
+fs::file_map::~file_map()
+{
+	if (m_ptr)
+	{
+#ifdef _WIN32
+		verify("file_map::~file_map" HERE), UnmapViewOfFile(m_ptr);
+#else
+		verify("file_map::~file_map" HERE), ::munmap(const_cast<u8*>(m_ptr), m_size) == 0;
+#endif
+	}
+}
+
+bool fs::file_map::open(const std::string& path)
+{
+	if (m_ptr)
+	{
+		fmt::throw_exception<std::logic_error>("fs::file_map is already opened");
+	}
+
+	if (get_virtual_device(path) || !fs::stat(path, m_info) || m_info.is_directory || !m_info.size)
+	{
+		g_tls_error = error::inval;
+		return false;
+	}
+
+#ifdef _WIN32
+	const HANDLE handle = CreateFileW(to_wchar(path).get(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+
+	if (handle == INVALID_HANDLE_VALUE)
+	{
+		g_tls_error = to_error(GetLastError());
+		return false;
+	}
+
+	LARGE_INTEGER size;
+	verify("file_map::open" HERE), GetFileSizeEx(handle, &size);
+
+	// The view keeps the mapping object (and the file) alive
+	const HANDLE mapping = size.QuadPart ? CreateFileMappingW(handle, NULL, PAGE_READONLY, 0, 0, NULL) : NULL;
+	const auto ptr = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+
+	if (mapping)
+	{
+		CloseHandle(mapping);
+	}
+
+	CloseHandle(handle);
+
+	if (!ptr)
+	{
+		g_tls_error = error::inval;
+		return false;
+	}
+
+	m_size = size.QuadPart;
+#else
+	const int fd = ::open(path.c_str(), O_RDONLY);
+
+	if (fd == -1)
+	{
+		g_tls_error = to_error(errno);
+		return false;
+	}
+
+	struct ::stat file_info;
+	verify("file_map::open" HERE), ::fstat(fd, &file_info) == 0;
+
+	// The mapping stays valid after the descriptor is closed
+	const auto ptr = S_ISREG(file_info.st_mode) && file_info.st_size ? ::mmap(nullptr, file_info.st_size, PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+
+	::close(fd);
+
+	if (ptr == MAP_FAILED)
+	{
+		g_tls_error = error::inval;
+		return false;
+	}
+
+	m_size = file_info.st_size;
+#endif
+
+	m_ptr = static_cast<const u8*>(ptr);
+	m_info.size = m_size;
+	return true;
+}
+
+void fs::file_map::advise(u64 offset, u64 size) const
+{
+	if (offset >= m_size || !size)
+	{
+		return;
+	}
+
+	size = std::min<u64>(size, m_size - offset);
+
+#ifdef _WIN32
+	// PrefetchVirtualMemory is only available since Windows 8 (do nothing otherwise)
+	struct range_entry
+	{
+		PVOID addr;
+		SIZE_T size;
+	};
+
+	using prefetch_t = BOOL(WINAPI*)(HANDLE, ULONG_PTR, range_entry*, ULONG);
+
+	static const auto prefetch = reinterpret_cast<prefetch_t>(utils::get_proc_address("kernel32.dll", "PrefetchVirtualMemory"));
+
+	if (prefetch)
+	{
+		range_entry range{const_cast<u8*>(m_ptr) + offset, static_cast<SIZE_T>(size)};
+		prefetch(GetCurrentProcess(), 1, &range, 0);
+	}
+#else
+	static const u64 page_size = ::sysconf(_SC_PAGESIZE);
+
+	const u64 start = offset / page_size * page_size;
+	::madvise(const_cast<u8*>(m_ptr) + start, offset + size - start, MADV_WILLNEED);
+#endif
+}
+
 void fs::dir::xnull() const
 {
 	fmt::throw_exception<std::logic_error>("fs::dir is null");
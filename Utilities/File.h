@@ -66,6 +66,9 @@ namespace fs
 		virtual u64 write(const void* buffer, u64 size) = 0;
 		virtual u64 seek(s64 offset, seek_mode whence) = 0;
 		virtual u64 size() = 0;
+
+		// Positional read which doesn't change the current position and may be used concurrently (false if not supported)
+		virtual bool read_at(u64 offset, void* buffer, u64 size, u64& result);
 	};
 
 	// Directory entry (TODO)
@@ -145,6 +148,50 @@ namespace fs
 	// Set file access/modification time
 	bool utime(const std::string& path, s64 atime, s64 mtime);
 
+	// Read-only memory mapping of the whole file
+	class file_map final
+	{
+		const u8* m_ptr = nullptr;
+		u64 m_size = 0;
+		stat_t m_info{};
+
+	public:
+		file_map() = default;
+
+		file_map(const file_map&) = delete;
+
+		file_map& operator=(const file_map&) = delete;
+
+		~file_map();
+
+		// Map the file (fails for virtual devices, directories and empty files)
+		bool open(const std::string& path);
+
+		// Hint that the range will be read soon
+		void advise(u64 offset, u64 size) const;
+
+		explicit operator bool() const
+		{
+			return m_ptr != nullptr;
+		}
+
+		const u8* data() const
+		{
+			return m_ptr;
+		}
+
+		u64 size() const
+		{
+			return m_size;
+		}
+
+		// File attributes at the time of mapping
+		const stat_t& info() const
+		{
+			return m_info;
+		}
+	};
+
 	class file final
 	{
 		std::unique_ptr<file_base> m_file;
@@ -162,6 +209,9 @@ namespace fs
 		// Open memory for read
 		explicit file(const void* ptr, std::size_t size);
 
+		// Open memory-mapped file for read (the mapping may be shared)
+		explicit file(const std::shared_ptr<const file_map>& map);
+
 		// Open file with specified args (forward to constructor)
 		template <typename... Args>
 		bool open(Args&&... args)
@@ -213,6 +263,13 @@ namespace fs
 			return m_file->read(buffer, count);
 		}
 
+		// Read the data at specified position without changing the current position (false if not supported)
+		bool read_at(u64 offset, void* buffer, u64 count, u64& result) const
+		{
+			if (!m_file) xnull();
+			return m_file->read_at(offset, buffer, count, result);
+		}
+
 		// Write the data to the file and return the amount of data actually written
 		u64 write(const void* buffer, u64 count) const
 		{
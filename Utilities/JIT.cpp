@@ -19,6 +19,10 @@
 #include "llvm/ExecutionEngine/ExecutionEngine.h"
 #include "llvm/ExecutionEngine/RTDyldMemoryManager.h"
 #include "llvm/ExecutionEngine/JITEventListener.h"
+#include "llvm/IR/LegacyPassManager.h"
+#include "llvm/Object/ObjectFile.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Target/TargetMachine.h"
 #ifdef _MSC_VER
 #pragma warning(pop)
 #endif
@@ -225,25 +229,13 @@ private:
 	void* m_next = s_memory;
 };
 
-// Helper class
-struct EventListener final : llvm::JITEventListener
+static void dummy()
 {
-	std::string path;
-
-	virtual void NotifyObjectEmitted(const llvm::object::ObjectFile& obj, const llvm::RuntimeDyld::LoadedObjectInfo& inf) override
-	{
-		if (!path.empty())
-		{
-			const llvm::StringRef elf = obj.getData();
-			fs::file(path, fs::rewrite).write(elf.data(), elf.size());
-		}
-	}
-};
-
-static EventListener s_listener;
+}
 
-static void dummy()
+static llvm::CodeModel::Model get_code_model()
 {
+	return (u64)s_memory <= 0x60000000 ? llvm::CodeModel::Small : llvm::CodeModel::Large; // TODO
 }
 
 jit_compiler::jit_compiler(std::unordered_map<std::string, std::uintptr_t> init_linkage_info, std::string _cpu)
@@ -277,7 +269,7 @@ jit_compiler::jit_compiler(std::unordered_map<std::string, std::uintptr_t> init_
 		.setErrorStr(&result)
 		.setMCJITMemoryManager(std::make_unique<MemoryManager>(m_link))
 		.setOptLevel(llvm::CodeGenOpt::Aggressive)
-		.setCodeModel((u64)s_memory <= 0x60000000 ? llvm::CodeModel::Small : llvm::CodeModel::Large) // TODO
+		.setCodeModel(get_code_model())
 		.setMCPU(m_cpu)
 		.create());
 
@@ -287,61 +279,64 @@ jit_compiler::jit_compiler(std::unordered_map<std::string, std::uintptr_t> init_
 	}
 
 	m_engine->setProcessAllSections(true); // ???
-	m_engine->RegisterJITEventListener(&s_listener);
 }
 
-void jit_compiler::load(std::unique_ptr<llvm::Module> module, std::unique_ptr<llvm::object::ObjectFile> object)
+std::string jit_compiler::compile(llvm::Module& module) const
 {
-	s_listener.path.clear();
+	std::string result;
 
-	auto* module_ptr = module.get();
+	// Create target machine with the same settings as the execution engine
+	const std::unique_ptr<llvm::TargetMachine> target(llvm::EngineBuilder()
+		.setErrorStr(&result)
+		.setOptLevel(llvm::CodeGenOpt::Aggressive)
+		.setCodeModel(get_code_model())
+		.setMCPU(m_cpu)
+		.selectTarget());
 
-	m_engine->addModule(std::move(module));
-	m_engine->addObjectFile(std::move(object));
-	m_engine->finalizeObject();
+	if (!target)
+	{
+		fmt::throw_exception("LLVM: Failed to create TargetMachine: %s" HERE, result);
+	}
 
-	m_map.clear();
+	module.setDataLayout(target->createDataLayout());
 
-	for (auto& func : module_ptr->functions())
-	{
-		const std::string& name = func.getName();
+	llvm::SmallVector<char, 0> buf;
+	llvm::raw_svector_ostream out(buf);
+	llvm::legacy::PassManager pm;
 
-		if (!m_link.count(name))
-		{
-			// Register compiled function
-			m_map[name] = m_engine->getFunctionAddress(name);
-		}
+	if (target->addPassesToEmitFile(pm, out, llvm::TargetMachine::CGFT_ObjectFile))
+	{
+		fmt::throw_exception("LLVM: Failed to emit object code for %s" HERE, module.getName().data());
 	}
 
-	init();
+	pm.run(module);
+
+	return {buf.data(), buf.size()};
 }
 
-void jit_compiler::make(std::unique_ptr<llvm::Module> module, std::string path)
+bool jit_compiler::load(const std::string& object, const std::vector<std::string>& names)
 {
-	s_listener.path = std::move(path);
+	auto buffer = llvm::MemoryBuffer::getMemBufferCopy(object);
+	auto result = llvm::object::ObjectFile::createObjectFile(buffer->getMemBufferRef());
 
-	auto* module_ptr = module.get();
+	if (!result)
+	{
+		return false;
+	}
 
-	m_engine->addModule(std::move(module));
+	m_engine->addObjectFile(llvm::object::OwningBinary<llvm::object::ObjectFile>(std::move(result.get()), std::move(buffer)));
 	m_engine->finalizeObject();
 
 	m_map.clear();
 
-	for (auto& func : module_ptr->functions())
+	for (const auto& name : names)
 	{
-		if (!func.empty())
-		{
-			const std::string& name = func.getName();
-
-			// Register compiled function
-			m_map[name] = m_engine->getFunctionAddress(name);
-		}
-
-		// Delete IR to lower memory consumption
-		func.deleteBody();
+		// Register compiled function
+		m_map[name] = m_engine->getFunctionAddress(name);
 	}
 
 	init();
+	return true;
 }
 
 void jit_compiler::init()
@@ -5,6 +5,7 @@
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "types.h"
 
@@ -44,11 +45,11 @@ public:
 	jit_compiler(std::unordered_map<std::string, std::uintptr_t>, std::string _cpu);
 	~jit_compiler();
 
-	// Compile module
-	void make(std::unique_ptr<llvm::Module>, std::string);
+	// Generate object code for the module (thread-safe, each thread must use its own LLVMContext)
+	std::string compile(llvm::Module&) const;
 
-	// Load object
-	void load(std::unique_ptr<llvm::Module>, std::unique_ptr<llvm::object::ObjectFile>);
+	// Load object code and register given functions (not thread-safe)
+	bool load(const std::string& object, const std::vector<std::string>& names);
 
 	// Get compiled function address
 	std::uintptr_t get(const std::string& name) const
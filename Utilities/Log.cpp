@@ -4,6 +4,8 @@
 
 #include "rpcs3_version.h"
 #include <string>
+#include <array>
+#include <thread>
 
 #ifdef _WIN32
 #include <Windows.h>
@@ -39,16 +41,44 @@ namespace logs
 {
 	class file_writer
 	{
+		// Ring buffer size (power of 2)
+		static const u64 s_buf_size = 0x800000;
+
 		// Could be memory-mapped file
 		fs::file m_file;
 
+		// Ring buffer (data is written to the file by the writer thread)
+		const std::unique_ptr<uchar[]> m_fptr;
+
+		// Position of reserved data
+		atomic_t<u64> m_buf{0};
+
+		// Lower bounds of positions of data being copied (-1 if unused)
+		std::array<atomic_t<u64>, 32> m_copy;
+
+		// Position of data written to the file
+		atomic_t<u64> m_out{0};
+
+		// Number of times the ring buffer was full
+		atomic_t<u64> m_stalls{0};
+
+		atomic_t<bool> m_stop{false};
+
+		std::thread m_writer;
+
+		// Write available data to the file (writer thread)
+		bool flush();
+
 	public:
 		file_writer(const std::string& name);
 
-		virtual ~file_writer() = default;
+		virtual ~file_writer();
 
 		// Append raw data
 		void log(const char* text, std::size_t size);
+
+		// Wait until all data appended so far is written
+		void sync();
 	};
 
 	struct file_listener : public file_writer, public listener
@@ -153,7 +183,13 @@ void logs::message::broadcast(const char* fmt, const fmt_type_info* sup, const u
 [[noreturn]] extern void catch_all_exceptions();
 
 logs::file_writer::file_writer(const std::string& name)
+	: m_fptr(new uchar[s_buf_size])
 {
+	for (auto& slot : m_copy)
+	{
+		slot = -1;
+	}
+
 	try
 	{
 		if (!m_file.open(fs::get_config_dir() + name, fs::rewrite + fs::append))
@@ -165,11 +201,162 @@ logs::file_writer::file_writer(const std::string& name)
 	{
 		catch_all_exceptions();
 	}
+
+	m_writer = std::thread([this]()
+	{
+		while (!m_stop)
+		{
+			if (!flush())
+			{
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			}
+		}
+	});
+}
+
+logs::file_writer::~file_writer()
+{
+	m_stop = true;
+	m_writer.join();
+
+	while (m_out < m_buf)
+	{
+		if (!flush())
+		{
+			std::this_thread::yield();
+		}
+	}
+
+	if (const u64 stalls = m_stalls)
+	{
+		const std::string& msg = fmt::format("Log buffer was full %llu times\n", stalls);
+		m_file.write(msg.data(), msg.size());
+	}
+}
+
+bool logs::file_writer::flush()
+{
+	const u64 out = m_out;
+
+	u64 end = m_buf;
+
+	// Only write the contiguous part which is already copied
+	for (const auto& slot : m_copy)
+	{
+		end = std::min<u64>(end, slot);
+	}
+
+	if (end <= out)
+	{
+		return false;
+	}
+
+	const u64 pos = out % s_buf_size;
+	const u64 size = end - out;
+
+	if (pos + size > s_buf_size)
+	{
+		m_file.write(m_fptr.get() + pos, s_buf_size - pos);
+		m_file.write(m_fptr.get(), pos + size - s_buf_size);
+	}
+	else
+	{
+		m_file.write(m_fptr.get() + pos, size);
+	}
+
+	m_out = end;
+	return true;
 }
 
 void logs::file_writer::log(const char* text, std::size_t size)
 {
-	m_file.write(text, size);
+	// Split huge messages
+	while (size > s_buf_size / 4)
+	{
+		log(text, s_buf_size / 4);
+		text += s_buf_size / 4;
+		size -= s_buf_size / 4;
+	}
+
+	if (!size)
+	{
+		return;
+	}
+
+	// Reserve space in the ring buffer
+	u64 pos;
+
+	atomic_t<u64>* slot;
+
+	while (true)
+	{
+		// Announce the copy before reserving (the current position is its lower bound)
+		for (u32 i = 0;; i++)
+		{
+			slot = &m_copy[i % m_copy.size()];
+
+			if (slot->compare_and_swap_test(-1, m_buf))
+			{
+				break;
+			}
+
+			if (i % m_copy.size() == m_copy.size() - 1)
+			{
+				std::this_thread::yield();
+			}
+		}
+
+		const u64 out = m_out;
+
+		bool full = false;
+
+		pos = m_buf.atomic_op([&](u64& v) -> u64
+		{
+			if (v + size > out + s_buf_size)
+			{
+				full = true;
+				return 0;
+			}
+
+			v += size;
+			return v - size;
+		});
+
+		if (LIKELY(!full))
+		{
+			break;
+		}
+
+		// Release the slot and wait for the writer thread
+		*slot = -1;
+		m_stalls++;
+		std::this_thread::yield();
+	}
+
+	const u64 off = pos % s_buf_size;
+
+	if (off + size > s_buf_size)
+	{
+		std::memcpy(m_fptr.get() + off, text, s_buf_size - off);
+		std::memcpy(m_fptr.get(), text + (s_buf_size - off), off + size - s_buf_size);
+	}
+	else
+	{
+		std::memcpy(m_fptr.get() + off, text, size);
+	}
+
+	// Commit
+	*slot = -1;
+}
+
+void logs::file_writer::sync()
+{
+	const u64 end = m_buf;
+
+	while (m_out < end && !m_stop)
+	{
+		std::this_thread::yield();
+	}
 }
 
 void logs::file_listener::log(u64 stamp, const logs::message& msg, const std::string& prefix, const std::string& _text)
@@ -217,4 +404,10 @@ void logs::file_listener::log(u64 stamp, const logs::message& msg, const std::st
 	text += '\n';
 
 	file_writer::log(text.data(), text.size());
+
+	// Don't lose important messages if the process is terminated
+	if (msg.sev <= level::error)
+	{
+		file_writer::sync();
+	}
 }
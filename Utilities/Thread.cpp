@@ -24,6 +24,8 @@
 
 #include "sync.h"
 
+#include <thread>
+
 thread_local u64 g_tls_fault_all = 0;
 thread_local u64 g_tls_fault_rsx = 0;
 thread_local u64 g_tls_fault_spu = 0;
@@ -1749,3 +1751,27 @@ void named_thread::start_thread(const std::shared_ptr<void>& _this)
 task_stack::task_base::~task_base()
 {
 }
+
+void run_parallel(const std::string& name, u32 count, const std::function<void(u32)>& func)
+{
+	const u32 thread_count = std::min<u32>(std::max<u32>(std::thread::hardware_concurrency(), 1), count);
+
+	atomic_t<u32> next{0};
+
+	const auto work = [&]()
+	{
+		for (u32 index; (index = next++) < count;)
+		{
+			func(index);
+		}
+	};
+
+	std::vector<std::unique_ptr<scope_thread>> workers;
+
+	for (u32 i = 1; i < thread_count; i++)
+	{
+		workers.emplace_back(std::make_unique<scope_thread>(std::string(name), work));
+	}
+
+	work();
+}
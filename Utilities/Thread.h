@@ -6,6 +6,7 @@
 #include <exception>
 #include <string>
 #include <memory>
+#include <functional>
 
 #include "sema.h"
 #include "cond.h"
@@ -315,3 +316,6 @@ public:
 		return m_thread.get();
 	}
 };
+
+// Run func(index) for every index in [0, count) on up to one thread per CPU core (the calling thread takes part)
+void run_parallel(const std::string& name, u32 count, const std::function<void(u32)>& func);
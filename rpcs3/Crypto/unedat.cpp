@@ -1,9 +1,16 @@
 #include "stdafx.h"
+#include "Utilities/Thread.h"
 #include "key_vault.h"
 #include "unedat.h"
 
 #include <cmath>
 
+// Decrypted data cached per file
+constexpr u64 EDAT_CACHE_SIZE = 2 * 1024 * 1024;
+
+// Blocks decrypted ahead of sequential reads
+constexpr u32 EDAT_READ_AHEAD_BLOCKS = 8;
+
 void generate_key(int crypto_mode, int version, unsigned char *key_final, unsigned char *iv_final, unsigned char *key, unsigned char *iv)
 {
 	int mode = (int)(crypto_mode & 0xF0000000);
@@ -935,44 +942,227 @@ bool EDATADecrypter::ReadHeader()
 
 	file_size = edatHeader.file_size;
 	total_blocks = (u32)((edatHeader.file_size + edatHeader.block_size - 1) / edatHeader.block_size);
+	cache_max_blocks = std::max<u32>(static_cast<u32>(EDAT_CACHE_SIZE / edatHeader.block_size), EDAT_READ_AHEAD_BLOCKS * 2);
 
 	return true;
 }
 
-u64 EDATADecrypter::ReadData(u64 pos, u8* data, u64 size)
+EDATADecrypter::~EDATADecrypter()
 {
-	if (pos > edatHeader.file_size)
-		return 0;
+	if (prefetch_thread)
+	{
+		prefetch_stop = true;
+		prefetch_thread->notify();
+		prefetch_thread->join();
+	}
+
+	if (stats.hits || stats.misses)
+	{
+		LOG_TRACE(LOADER, "EDAT: block cache stats: hits=%llu, misses=%llu, prefetched=%llu (used %llu)", stats.hits, stats.misses, stats.prefetched, stats.prefetch_hits);
+	}
+}
+
+std::unique_ptr<u8[]> EDATADecrypter::DecryptBlock(u32 block, u64& size)
+{
+	std::unique_ptr<u8[]> data(new u8[edatHeader.block_size]);
+
+	std::lock_guard<std::mutex> lock(file_mutex);
+
+	edata_file.seek(0);
+	const s64 res = decrypt_block(&edata_file, data.get(), &edatHeader, &npdHeader, dec_key.data(), block, total_blocks, edatHeader.file_size);
+
+	if (res < 0)
+	{
+		return nullptr;
+	}
+
+	size = res;
+	return data;
+}
+
+void EDATADecrypter::CacheBlock(u32 block, std::unique_ptr<u8[]> data, u64 size, bool prefetched)
+{
+	if (cache.count(block))
+	{
+		// Already decrypted by another thread
+		return;
+	}
+
+	while (cache.size() >= cache_max_blocks && !cache_lru.empty())
+	{
+		cache.erase(cache_lru.back());
+		cache_lru.pop_back();
+	}
+
+	cache_lru.push_front(block);
+	cache.emplace(block, cached_block{std::move(data), size, prefetched, cache_lru.begin()});
+}
+
+s64 EDATADecrypter::ReadBlock(u32 block, u64 offset, u8* out, u64 size)
+{
+	{
+		std::lock_guard<std::mutex> lock(cache_mutex);
+
+		const auto found = cache.find(block);
+
+		if (found != cache.end())
+		{
+			auto& entry = found->second;
+
+			stats.hits++;
+
+			if (entry.prefetched)
+			{
+				stats.prefetch_hits++;
+				entry.prefetched = false;
+			}
+
+			// Move to the front of the LRU list
+			cache_lru.splice(cache_lru.begin(), cache_lru, entry.lru);
+
+			const u64 count = offset < entry.size ? std::min(size, entry.size - offset) : 0;
+			std::memcpy(out, entry.data.get() + offset, count);
+			return count;
+		}
+
+		stats.misses++;
+	}
+
+	u64 block_size;
+	auto data = DecryptBlock(block, block_size);
+
+	if (!data)
+	{
+		return -1;
+	}
+
+	const u64 count = offset < block_size ? std::min(size, block_size - offset) : 0;
+	std::memcpy(out, data.get() + offset, count);
+
+	std::lock_guard<std::mutex> lock(cache_mutex);
+	CacheBlock(block, std::move(data), block_size, false);
+	return count;
+}
+
+void EDATADecrypter::Prefetch()
+{
+	// Called with cache_mutex locked
+	if (sequential_reads < 2)
+	{
+		return;
+	}
+
+	const u32 start = last_block + 1;
 
-	// now we need to offset things to account for the actual 'range' requested
-	const u64 startOffset = pos % edatHeader.block_size;
+	prefetch_end = std::min(start + EDAT_READ_AHEAD_BLOCKS, total_blocks);
+
+	// Restart the read-ahead at the reader position if it's outside of the window (after a seek)
+	if (prefetch_pos < start || prefetch_pos > prefetch_end)
+	{
+		prefetch_pos = start;
+	}
 
-	const u32 num_blocks = static_cast<u32>(std::ceil((startOffset + size) / (double)edatHeader.block_size));
-	const u64 bufSize = num_blocks*edatHeader.block_size;
-	if (data_buf_size < (bufSize))
+	if (prefetch_pos >= prefetch_end)
 	{
-		data_buf.reset(new u8[bufSize]);
-		data_buf_size = bufSize;
+		return;
 	}
 
+	if (prefetch_thread)
+	{
+		prefetch_thread->notify();
+		return;
+	}
+
+	thread_ctrl::spawn(prefetch_thread, "EDAT Read-ahead", [this]()
+	{
+		while (!prefetch_stop)
+		{
+			u32 block = -1;
+			{
+				std::lock_guard<std::mutex> lock(cache_mutex);
+
+				while (prefetch_pos < prefetch_end && cache.count(prefetch_pos))
+				{
+					prefetch_pos++;
+				}
+
+				if (prefetch_pos < prefetch_end)
+				{
+					block = prefetch_pos++;
+				}
+			}
+
+			if (block == -1)
+			{
+				thread_ctrl::wait();
+				continue;
+			}
+
+			u64 size;
+			auto data = DecryptBlock(block, size);
+
+			if (!data)
+			{
+				// The error will be reported by the reader
+				continue;
+			}
+
+			std::lock_guard<std::mutex> lock(cache_mutex);
+			stats.prefetched++;
+			CacheBlock(block, std::move(data), size, true);
+		}
+	});
+}
+
+u64 EDATADecrypter::ReadData(u64 pos, u8* data, u64 size)
+{
+	if (pos >= edatHeader.file_size || !size)
+		return 0;
+
+	size = std::min<u64>(size, edatHeader.file_size - pos);
+
 	// find and decrypt block range covering pos + size
 	const u32 starting_block = static_cast<u32>(pos / edatHeader.block_size);
-	const u32 ending_block = std::min(starting_block + num_blocks, total_blocks);
-	u64 writeOffset = 0;
-	for (u32 i = starting_block; i < ending_block; ++i)
+	u32 block = starting_block;
+	u64 bytesWrote = 0;
+
+	for (; bytesWrote < size && block < total_blocks; block++)
 	{
-		edata_file.seek(0);
-		u64 res = decrypt_block(&edata_file, &data_buf[writeOffset], &edatHeader, &npdHeader, dec_key.data(), i, total_blocks, edatHeader.file_size);
-		if (res == -1)
+		// now we need to offset things to account for the actual 'range' requested
+		const u64 offset = block == starting_block ? pos % edatHeader.block_size : 0;
+
+		const s64 res = ReadBlock(block, offset, data + bytesWrote, size - bytesWrote);
+
+		if (res < 0)
 		{
 			LOG_ERROR(LOADER, "Error Decrypting data");
 			return 0;
 		}
-		writeOffset += res;
+
+		if (res == 0)
+		{
+			break;
+		}
+
+		bytesWrote += res;
+	}
+
+	std::lock_guard<std::mutex> lock(cache_mutex);
+
+	// Detect sequential access (the read continues where the previous one ended)
+	if (starting_block == last_block || starting_block == last_block + 1)
+	{
+		sequential_reads++;
+	}
+	else
+	{
+		// Random access: read-ahead will restart from the new position
+		sequential_reads = 0;
+		prefetch_pos = block;
 	}
 
-	const u64 bytesWrote = std::min<u64>(writeOffset - startOffset, size);
+	last_block = block - 1;
+	Prefetch();
 
-	memcpy(data, &data_buf[startOffset], bytesWrote);
 	return bytesWrote;
 }
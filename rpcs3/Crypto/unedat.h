@@ -3,8 +3,14 @@
 #include <stdio.h>
 #include <string.h>
 #include <array>
+#include <list>
+#include <mutex>
+#include <unordered_map>
 
 #include "utils.h"
+#include "Utilities/Atomic.h"
+
+class thread_ctrl;
 
 constexpr u32 SDAT_FLAG = 0x01000000;
 constexpr u32 EDAT_COMPRESSED_FLAG = 0x00000001;
@@ -59,15 +65,61 @@ struct EDATADecrypter final : fs::file_base
 	NPD_HEADER npdHeader;
 	EDAT_HEADER edatHeader;
 
-	// Internal data buffers.
-	std::unique_ptr<u8[]> data_buf;
-	u64 data_buf_size{0};
-
 	std::array<u8, 0x10> dec_key{};
 
 	// edat usage
 	std::array<u8, 0x10> rif_key{};
 	std::array<u8, 0x10> dev_key{};
+
+	// Decrypted block cache (LRU)
+	struct cached_block
+	{
+		std::unique_ptr<u8[]> data;
+		u64 size;
+		bool prefetched; // not accessed since read-ahead
+		std::list<u32>::iterator lru;
+	};
+
+	std::mutex cache_mutex;
+	std::unordered_map<u32, cached_block> cache;
+	std::list<u32> cache_lru; // most recently used first
+	u32 cache_max_blocks{0};
+
+	// Protects edata_file position during decryption
+	std::mutex file_mutex;
+
+	// Sequential read-ahead (protected by cache_mutex)
+	std::shared_ptr<thread_ctrl> prefetch_thread;
+	atomic_t<bool> prefetch_stop{false};
+	u32 prefetch_pos{0};
+	u32 prefetch_end{0};
+	u32 last_block{~0u};
+	u32 sequential_reads{0};
+
+public:
+	struct stats_t
+	{
+		u64 hits;
+		u64 misses;
+		u64 prefetched;
+		u64 prefetch_hits;
+	};
+
+private:
+	stats_t stats{};
+
+	// Decrypt single block, returns nullptr on failure
+	std::unique_ptr<u8[]> DecryptBlock(u32 block, u64& size);
+
+	// Put decrypted block in the cache
+	void CacheBlock(u32 block, std::unique_ptr<u8[]> data, u64 size, bool prefetched);
+
+	// Copy part of the block (decrypted if necessary), returns copied size or -1
+	s64 ReadBlock(u32 block, u64 offset, u8* out, u64 size);
+
+	// Schedule read-ahead after sequential access
+	void Prefetch();
+
 public:
 	// SdataByFd usage
 	EDATADecrypter(fs::file&& input)
@@ -76,11 +128,17 @@ public:
 	EDATADecrypter(fs::file&& input, const std::array<u8, 0x10>& dev_key, const std::array<u8, 0x10>& rif_key)
 		: edata_file(std::move(input)), rif_key(rif_key), dev_key(dev_key) {}
 
-	~EDATADecrypter() override {}
+	~EDATADecrypter() override;
 	// false if invalid 
 	bool ReadHeader();
 	u64 ReadData(u64 pos, u8* data, u64 size);
 
+	stats_t get_stats()
+	{
+		std::lock_guard<std::mutex> lock(cache_mutex);
+		return stats;
+	}
+
 	fs::stat_t stat() override
 	{
 		fs::stat_t stats;
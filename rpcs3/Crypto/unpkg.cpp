@@ -4,6 +4,12 @@
 #include "sha1.h"
 #include "key_vault.h"
 #include "unpkg.h"
+#include "Utilities/Thread.h"
+
+#include <thread>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
 
 bool pkg_install(const fs::file& pkg_f, const std::string& dir, atomic_t<double>& sync)
 {
@@ -107,16 +113,11 @@ bool pkg_install(const fs::file& pkg_f, const std::string& dir, atomic_t<double>
 	// Allocate buffer with BUF_SIZE size or more if required
 	const std::unique_ptr<u128[]> buf(new u128[std::max<u64>(BUF_SIZE, sizeof(PKGEntry) * header.file_count) / sizeof(u128)]);
 
-	// Define decryption subfunction (`psp` arg selects the key for specific block)
-	auto decrypt = [&](u64 offset, u64 size, const uchar* key) -> u64
+	// Decrypt the data in place (`offset` selects the position in the stream)
+	auto decrypt_data = [&](u64 offset, u64 size, const uchar* key, u128* data)
 	{
-		pkg_f.seek(start_offset + header.data_offset + offset);
-
-		// Read the data and set available size
-		const u64 read = pkg_f.read(buf.get(), size);
-
 		// Get block count
-		const u64 blocks = (read + 15) / 16;
+		const u64 blocks = (size + 15) / 16;
 
 		if (header.pkg_type == PKG_RELEASE_TYPE_DEBUG)
 		{
@@ -142,7 +143,7 @@ bool pkg_install(const fs::file& pkg_f, const std::string& dir, atomic_t<double>
 				
 				sha1(reinterpret_cast<const u8*>(input), sizeof(input), hash.data);
 
-				buf[i] ^= hash._v128;
+				data[i] ^= hash._v128;
 			}
 		}
 
@@ -163,9 +164,20 @@ bool pkg_install(const fs::file& pkg_f, const std::string& dir, atomic_t<double>
 
 				aes_crypt_ecb(&ctx, AES_ENCRYPT, reinterpret_cast<const u8*>(&input), reinterpret_cast<u8*>(&key));
 
-				buf[i] ^= key;
+				data[i] ^= key;
 			}
 		}
+	};
+
+	// Define decryption subfunction (`psp` arg selects the key for specific block)
+	auto decrypt = [&](u64 offset, u64 size, const uchar* key) -> u64
+	{
+		pkg_f.seek(start_offset + header.data_offset + offset);
+
+		// Read the data and set available size
+		const u64 read = pkg_f.read(buf.get(), size);
+
+		decrypt_data(offset, read, key, buf.get());
 
 		// Return the amount of data written in buf
 		return read;
@@ -192,6 +204,110 @@ bool pkg_install(const fs::file& pkg_f, const std::string& dir, atomic_t<double>
 
 	std::vector<PKGEntry> entries(header.file_count);
 
+	// Output file (shared with the worker threads)
+	struct out_file
+	{
+		fs::file file;
+		std::string path;
+		u64 written = 0; // Amount of data written (the next chunk to write starts there)
+		bool failed = false;
+	};
+
+	// Chunk of file data read by the installer thread, decrypted and written by a worker thread
+	struct data_task
+	{
+		std::shared_ptr<out_file> out;
+		u64 offset; // Position in the stream
+		u64 pos; // Position in the output file
+		u64 size;
+		const uchar* key;
+		u128* data;
+	};
+
+	// Size of a chunk processed by a single task
+	const u64 task_size = 1024 * 1024;
+
+	// Number of worker threads
+	const u32 thread_count = std::max<u32>(std::thread::hardware_concurrency(), 1);
+
+	// Pipeline state (protected by mutex)
+	std::mutex mutex;
+	std::condition_variable cv;
+	std::deque<data_task> tasks;
+	std::vector<u128*> free_bufs;
+	bool stop = false;
+
+	// Chunk buffers: read-ahead of one chunk per worker in addition to the chunks being processed
+	std::vector<std::unique_ptr<u128[]>> data_bufs(thread_count * 2);
+
+	for (auto& ptr : data_bufs)
+	{
+		ptr.reset(new u128[task_size / sizeof(u128)]);
+		free_bufs.emplace_back(ptr.get());
+	}
+
+	// Decrypt chunks in parallel, write them in order within each file (different files are written in parallel)
+	auto work = [&]()
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+
+		while (true)
+		{
+			cv.wait(lock, [&] { return stop || !tasks.empty(); });
+
+			if (tasks.empty())
+			{
+				return;
+			}
+
+			const data_task task = std::move(tasks.front());
+			tasks.pop_front();
+			lock.unlock();
+
+			decrypt_data(task.offset, task.size, task.key, task.data);
+
+			// Wait for the preceding chunks of the file (they were queued and taken earlier)
+			lock.lock();
+			cv.wait(lock, [&] { return task.out->written == task.pos; });
+
+			if (!task.out->failed)
+			{
+				lock.unlock();
+				const bool ok = task.out->file.write(task.data, task.size) == task.size;
+				lock.lock();
+
+				if (!ok)
+				{
+					LOG_ERROR(LOADER, "Failed to write file %s", task.out->path);
+					task.out->failed = true;
+				}
+			}
+
+			task.out->written += task.size;
+			free_bufs.emplace_back(task.data);
+			cv.notify_all();
+		}
+	};
+
+	std::vector<std::unique_ptr<scope_thread>> workers;
+
+	for (u32 i = 0; i < thread_count; i++)
+	{
+		workers.emplace_back(std::make_unique<scope_thread>("PKG Worker", work));
+	}
+
+	// Let the workers process the queued chunks and exit
+	auto finish = [&]()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stop = true;
+		}
+
+		cv.notify_all();
+		workers.clear();
+	};
+
 	std::memcpy(entries.data(), buf.get(), entries.size() * sizeof(PKGEntry));
 
 	for (const auto& entry : entries)
@@ -228,26 +344,56 @@ bool pkg_install(const fs::file& pkg_f, const std::string& dir, atomic_t<double>
 
 			const bool did_overwrite = fs::is_file(path);
 
-			if (fs::file out{ path, fs::rewrite })
+			const auto out = std::make_shared<out_file>();
+
+			if (out->file.open(path, fs::rewrite))
 			{
-				for (u64 pos = 0; pos < entry.file_size; pos += BUF_SIZE)
+				const uchar* key = is_psp ? PKG_AES_KEY2 : dec_key.data();
+
+				out->path = path;
+
+				for (u64 pos = 0; pos < entry.file_size; pos += task_size)
 				{
-					const u64 block_size = std::min<u64>(BUF_SIZE, entry.file_size - pos);
+					const u64 size = std::min<u64>(task_size, entry.file_size - pos);
+					const u64 offset = entry.file_offset + pos;
+
+					// Get a free buffer
+					u128* data;
+					{
+						std::unique_lock<std::mutex> lock(mutex);
+						cv.wait(lock, [&] { return !free_bufs.empty(); });
+
+						if (out->failed)
+						{
+							break;
+						}
+
+						data = free_bufs.back();
+						free_bufs.pop_back();
+					}
+
+					pkg_f.seek(start_offset + header.data_offset + offset);
 
-					if (decrypt(entry.file_offset + pos, block_size, is_psp ? PKG_AES_KEY2 : dec_key.data()) != block_size)
+					if (pkg_f.read(data, size) != size)
 					{
 						LOG_ERROR(LOADER, "Failed to extract file %s", path);
+
+						std::lock_guard<std::mutex> lock(mutex);
+						free_bufs.emplace_back(data);
 						break;
 					}
 
-					if (out.write(buf.get(), block_size) != block_size)
+					// Decrypt and write in background
 					{
-						LOG_ERROR(LOADER, "Failed to write file %s", path);
-						break;
+						std::lock_guard<std::mutex> lock(mutex);
+						tasks.push_back(data_task{out, offset, pos, size, key, data});
 					}
 
-					if (sync.fetch_add((block_size + 0.0) / header.data_size) < 0.)
+					cv.notify_all();
+
+					if (sync.fetch_add((size + 0.0) / header.data_size) < 0.)
 					{
+						finish();
 						LOG_ERROR(LOADER, "Package installation cancelled: %s", dir);
 						return false;
 					}
@@ -298,6 +444,9 @@ bool pkg_install(const fs::file& pkg_f, const std::string& dir, atomic_t<double>
 		}
 	}
 
+	// Wait for the last chunks
+	finish();
+
 	LOG_SUCCESS(LOADER, "Package successfully installed to %s", dir);
 	return true;
 }
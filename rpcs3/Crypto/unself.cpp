@@ -4,10 +4,14 @@
 #include "utils.h"
 #include "unself.h"
 #include "Emu/VFS.h"
+#include "Utilities/Thread.h"
 
 // TODO: Still reliant on wxWidgets for zlib functions. Alternative solutions?
 #include <zlib.h>
 
+// Minimal amount of data processed by a single task
+static const u32 self_task_size = 0x40000;
+
 inline u8 Read8(const fs::file& f)
 {
 	u8 ret;
@@ -1207,7 +1211,11 @@ bool SELFDecrypter::LoadMetadata()
 
 bool SELFDecrypter::DecryptData()
 {
-	aes_context aes;
+	// Encrypted section: metadata section index and offset in data_buf
+	std::vector<std::pair<u32, u32>> sections;
+
+	// Decryption task: section (index in sections) and offset in the section
+	std::vector<std::pair<u32, u32>> tasks;
 
 	// Calculate the total data size.
 	for (unsigned int i = 0; i < meta_hdr.section_count; i++)
@@ -1215,68 +1223,110 @@ bool SELFDecrypter::DecryptData()
 		if (meta_shdr[i].encrypted == 3)
 		{
 			if ((meta_shdr[i].key_idx <= meta_hdr.key_count - 1) && (meta_shdr[i].iv_idx <= meta_hdr.key_count))
+			{
+				// The stream cipher can be started at any block, so big sections are split
+				for (u32 pos = 0; pos < meta_shdr[i].data_size; pos += self_task_size)
+				{
+					tasks.emplace_back(::size32(sections), pos);
+				}
+
+				sections.emplace_back(i, data_buf_length);
 				data_buf_length += meta_shdr[i].data_size;
+			}
 		}
 	}
 
 	// Allocate a buffer to store decrypted data.
 	data_buf = std::make_unique<u8[]>(data_buf_length);
 
-	// Set initial offset.
-	u32 data_buf_offset = 0;
+	// Read the encrypted data directly into the buffer.
+	for (const auto& sec : sections)
+	{
+		self_f.seek(meta_shdr[sec.first].data_offset);
+		self_f.read(data_buf.get() + sec.second, meta_shdr[sec.first].data_size);
+	}
 
-	// Parse the metadata section headers to find the offsets of encrypted data.
-	for (unsigned int i = 0; i < meta_hdr.section_count; i++)
+	// Perform AES-CTR decryption in place.
+	run_parallel("SELF Decrypter", ::size32(tasks), [&](u32 index)
 	{
+		const auto& sec = sections[tasks[index].first];
+		const auto& shdr = meta_shdr[sec.first];
+		const u32 pos = tasks[index].second;
+
 		size_t ctr_nc_off = 0;
-		u8 ctr_stream_block[0x10];
+		u8 ctr_stream_block[0x10]{};
 		u8 data_key[0x10];
 		u8 data_iv[0x10];
 
-		// Check if this is an encrypted section.
-		if (meta_shdr[i].encrypted == 3)
-		{
-			// Make sure the key and iv are not out of boundaries.
-			if((meta_shdr[i].key_idx <= meta_hdr.key_count - 1) && (meta_shdr[i].iv_idx <= meta_hdr.key_count))
-			{
-				// Get the key and iv from the previously stored key buffer.
-				memcpy(data_key, data_keys.get() + meta_shdr[i].key_idx * 0x10, 0x10);
-				memcpy(data_iv, data_keys.get() + meta_shdr[i].iv_idx * 0x10, 0x10);
-
-				// Allocate a buffer to hold the data.
-				auto buf = std::make_unique<u8[]>(meta_shdr[i].data_size);
-
-				// Seek to the section data offset and read the encrypted data.
-				self_f.seek(meta_shdr[i].data_offset);
-				self_f.read(buf.get(), meta_shdr[i].data_size);
-
-				// Zero out our ctr nonce.
-				memset(ctr_stream_block, 0, sizeof(ctr_stream_block));
+		// Get the key and iv from the previously stored key buffer.
+		memcpy(data_key, data_keys.get() + shdr.key_idx * 0x10, 0x10);
+		memcpy(data_iv, data_keys.get() + shdr.iv_idx * 0x10, 0x10);
 
-				// Perform AES-CTR encryption on the data blocks.
-				aes_setkey_enc(&aes, data_key, 128);
-				aes_crypt_ctr(&aes, meta_shdr[i].data_size, &ctr_nc_off, data_iv, ctr_stream_block, buf.get(), buf.get());
+		// Advance the counter (128-bit big-endian) to the task's first block.
+		for (u32 i = 16, carry = pos / 16; i > 0 && carry; i--)
+		{
+			carry += data_iv[i - 1];
+			data_iv[i - 1] = static_cast<u8>(carry);
+			carry >>= 8;
+		}
 
-				// Copy the decrypted data.
-				memcpy(data_buf.get() + data_buf_offset, buf.get(), meta_shdr[i].data_size);
+		aes_context aes;
+		aes_setkey_enc(&aes, data_key, 128);
 
-				// Advance the buffer's offset.
-				data_buf_offset += meta_shdr[i].data_size;
-			}
-		}
-	}
+		u8* const data = data_buf.get() + sec.second + pos;
+		aes_crypt_ctr(&aes, std::min<u32>(shdr.data_size - pos, self_task_size), &ctr_nc_off, data_iv, ctr_stream_block, data, data);
+	});
 
 	return true;
 }
 
 fs::file SELFDecrypter::MakeElf(bool isElf32)
 {
-	// Create a new ELF file.
-	fs::file e = fs::make_stream<std::vector<u8>>();
+	// Output ELF file data.
+	std::vector<u8> elf;
+
+	// Headers are written through the stream, section data directly.
+	fs::file e = fs::make_stream<std::vector<u8>&>(elf);
+
+	// Section data copy: destination offset, size, source offset in data_buf, compressed flag
+	struct section_copy
+	{
+		u64 offset;
+		u64 size;
+		u32 data_offset;
+		bool compressed;
+	};
+
+	std::vector<section_copy> copies;
 
 	// Set initial offset.
 	u32 data_buf_offset = 0;
 
+	for (unsigned int i = 0; i < meta_hdr.section_count; i++)
+	{
+		// PHDR type.
+		if (meta_shdr[i].type == 2)
+		{
+			const u32 idx = meta_shdr[i].program_idx;
+
+			if (isElf32)
+			{
+				copies.push_back({phdr32_arr[idx].p_offset, meta_shdr[i].data_size, data_buf_offset, false});
+			}
+			else if (meta_shdr[i].compressed == 2)
+			{
+				copies.push_back({phdr64_arr[idx].p_offset, phdr64_arr[idx].p_filesz, data_buf_offset, true});
+			}
+			else
+			{
+				copies.push_back({phdr64_arr[idx].p_offset, meta_shdr[i].data_size, data_buf_offset, false});
+			}
+
+			// Advance the data buffer offset by data size.
+			data_buf_offset += meta_shdr[i].data_size;
+		}
+	}
+
 	if (isElf32)
 	{
 		// Write ELF header.
@@ -1287,97 +1337,88 @@ fs::file SELFDecrypter::MakeElf(bool isElf32)
 		{
 			WritePhdr(e, phdr32_arr[i]);
 		}
+	}
+	else
+	{
+		// Write ELF header.
+		WriteEhdr(e, elf64_hdr);
 
-		for (unsigned int i = 0; i < meta_hdr.section_count; i++)
+		// Write program headers.
+		for (u32 i = 0; i < elf64_hdr.e_phnum; ++i)
 		{
-			// PHDR type.
-			if (meta_shdr[i].type == 2)
-			{
-				// Seek to the program header data offset and write the data.
-				e.seek(phdr32_arr[meta_shdr[i].program_idx].p_offset);
-				e.write(data_buf.get() + data_buf_offset, meta_shdr[i].data_size);
+			WritePhdr(e, phdr64_arr[i]);
+		}
+	}
 
-				// Advance the data buffer offset by data size.
-				data_buf_offset += meta_shdr[i].data_size;
-			}
+	// Grow the output to fit all section data (zero-filled like stream gaps).
+	bool overlap = false;
+
+	for (const auto& copy : copies)
+	{
+		for (const auto& other : copies)
+		{
+			overlap = overlap || (&copy != &other && copy.offset < other.offset + other.size && other.offset < copy.offset + copy.size);
 		}
 
-		// Write section headers.
-		if (self_hdr.se_shdroff != 0)
+		if (elf.size() < copy.offset + copy.size)
 		{
-			e.seek(elf32_hdr.e_shoff);
+			elf.resize(copy.offset + copy.size);
+		}
+	}
 
-			for (u32 i = 0; i < elf32_hdr.e_shnum; ++i)
+	// Decompress or copy the section data straight into the output.
+	auto process = [&](u32 index)
+	{
+		const auto& copy = copies[index];
+
+		if (copy.compressed)
+		{
+			// decomp_buf_length changes inside the call to uncompress, so it must be a pointer to correct type (in writeable mem space).
+			uLongf decomp_buf_length = static_cast<uLongf>(copy.size);
+
+			int rv = uncompress(elf.data() + copy.offset, &decomp_buf_length, data_buf.get() + copy.data_offset, data_buf_length - copy.data_offset);
+
+			// Check for errors (TODO: Probably safe to remove this once these changes have passed testing.)
+			switch (rv)
 			{
-				WriteShdr(e, shdr32_arr[i]);
+			case Z_MEM_ERROR:	LOG_ERROR(LOADER, "MakeELF encountered a Z_MEM_ERROR!"); break;
+			case Z_BUF_ERROR:	LOG_ERROR(LOADER, "MakeELF encountered a Z_BUF_ERROR!"); break;
+			case Z_DATA_ERROR:	LOG_ERROR(LOADER, "MakeELF encountered a Z_DATA_ERROR!"); break;
+			default: break;
 			}
 		}
+		else
+		{
+			std::memcpy(elf.data() + copy.offset, data_buf.get() + copy.data_offset, copy.size);
+		}
+	};
+
+	if (overlap)
+	{
+		// Keep the order of writes
+		for (u32 i = 0; i < copies.size(); i++)
+		{
+			process(i);
+		}
 	}
 	else
 	{
-		// Write ELF header.
-		WriteEhdr(e, elf64_hdr);
+		run_parallel("SELF Decrypter", ::size32(copies), process);
+	}
 
-		// Write program headers.
-		for (u32 i = 0; i < elf64_hdr.e_phnum; ++i)
+	// Write section headers.
+	if (self_hdr.se_shdroff != 0)
+	{
+		if (isElf32)
 		{
-			WritePhdr(e, phdr64_arr[i]);
-		}
+			e.seek(elf32_hdr.e_shoff);
 
-		// Write data.
-		for (unsigned int i = 0; i < meta_hdr.section_count; i++)
-		{
-			// PHDR type.
-			if (meta_shdr[i].type == 2)
+			for (u32 i = 0; i < elf32_hdr.e_shnum; ++i)
 			{
-				// Decompress if necessary.
-				if (meta_shdr[i].compressed == 2)
-				{
-					/// Removed all wxWidget dependent code. Replaced with zlib functions.
-					/// Also changed local mallocs to unique_ptrs.
-
-					// Store the length in writeable memory space.
-					std::unique_ptr<uLongf> decomp_buf_length(new uLongf);
-					memcpy(decomp_buf_length.get(), &phdr64_arr[meta_shdr[i].program_idx].p_filesz, sizeof(uLongf));
-
-					/// Create a pointer to a buffer for decompression.
-					std::unique_ptr<u8[]> decomp_buf(new u8[phdr64_arr[meta_shdr[i].program_idx].p_filesz]);
-
-					// Create a buffer separate from data_buf to uncompress.
-					std::unique_ptr<u8[]> zlib_buf(new u8[data_buf_length]);
-					memcpy(zlib_buf.get(), data_buf.get(), data_buf_length);
-
-					// Use zlib uncompress on the new buffer.
-					// decomp_buf_length changes inside the call to uncompress, so it must be a pointer to correct type (in writeable mem space).
-					int rv = uncompress(decomp_buf.get(), decomp_buf_length.get(), zlib_buf.get() + data_buf_offset, data_buf_length);
-
-					// Check for errors (TODO: Probably safe to remove this once these changes have passed testing.)
-					switch (rv)
-					{
-					case Z_MEM_ERROR:	LOG_ERROR(LOADER, "MakeELF encountered a Z_MEM_ERROR!"); break;
-					case Z_BUF_ERROR:	LOG_ERROR(LOADER, "MakeELF encountered a Z_BUF_ERROR!"); break;
-					case Z_DATA_ERROR:	LOG_ERROR(LOADER, "MakeELF encountered a Z_DATA_ERROR!"); break;
-					default: break;
-					}
-
-					// Seek to the program header data offset and write the data.
-					e.seek(phdr64_arr[meta_shdr[i].program_idx].p_offset);
-					e.write(decomp_buf.get(), phdr64_arr[meta_shdr[i].program_idx].p_filesz);
-				}
-				else
-				{
-					// Seek to the program header data offset and write the data.
-					e.seek(phdr64_arr[meta_shdr[i].program_idx].p_offset);
-					e.write(data_buf.get() + data_buf_offset, meta_shdr[i].data_size);
-				}
-
-				// Advance the data buffer offset by data size.
-				data_buf_offset += meta_shdr[i].data_size;
+				WriteShdr(e, shdr32_arr[i]);
 			}
 		}
-
-		// Write section headers.
-		if (self_hdr.se_shdroff != 0)
+		else
 		{
 			e.seek(elf64_hdr.e_shoff);
 
@@ -1388,7 +1429,7 @@ fs::file SELFDecrypter::MakeElf(bool isElf32)
 		}
 	}
 
-	return e;
+	return fs::make_stream(std::move(elf));
 }
 
 bool SELFDecrypter::GetKeyFromRap(u8* content_id, u8* npdrm_key)
@@ -39,6 +39,11 @@ public:
 	// Public thread state
 	atomic_t<bs_t<cpu_flag>> state{+cpu_flag::stop};
 
+	// Links and heap position in the LV2 sleep queue (see lv2_sleep_queue)
+	cpu_thread* sleep_prev = nullptr;
+	cpu_thread* sleep_next = nullptr;
+	u32 sleep_index = -1;
+
 	// Process thread state, return true if the checker must return
 	bool check_state();
 
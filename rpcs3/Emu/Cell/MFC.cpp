@@ -143,48 +143,33 @@ void mfc_thread::cpu_task()
 					no_updates = 0;
 
 					// Store unconditionally
-					vm::writer_lock lock(0);
-					data = to_write;
-					vm::reservation_update(cmd.eal, 128);
+					{
+						vm::writer_lock lock(0);
+						vm::reservation_lock(cmd.eal, 128);
+						data = to_write;
+						vm::reservation_update(cmd.eal, 128);
+					}
+
 					vm::notify(cmd.eal, 128);
 				}
 				else if (cmd.cmd & MFC_LIST_MASK)
 				{
-					struct list_element
-					{
-						be_t<u16> sb; // Stall-and-Notify bit (0x8000)
-						be_t<u16> ts; // List Transfer Size
-						be_t<u32> ea; // External Address Low
-					};
-
 					if (cmd.size && (spu.ch_stall_mask & (1u << cmd.tag)) == 0)
 					{
-						cmd.lsa &= 0x3fff0;
-
-						const list_element item = spu._ref<list_element>(cmd.eal & 0x3fff8);
+						spu_mfc_cmd transfer;
+						bool stall;
 
-						const u32 size = item.ts;
-						const u32 addr = item.ea;
+						// Process contiguous elements at once (up to the max DMA size)
+						spu.get_list_transfer(cmd, transfer, 0x4000, stall);
 
-						if (size)
+						if (transfer.size)
 						{
-							spu_mfc_cmd transfer;
-							transfer.eal = addr;
-							transfer.eah = 0;
-							transfer.lsa = cmd.lsa | (addr & 0xf);
-							transfer.tag = cmd.tag;
-							transfer.cmd = MFC(cmd.cmd & ~MFC_LIST_MASK);
-							transfer.size = size;
-
 							spu.do_dma_transfer(transfer);
-							cmd.lsa += std::max<u32>(size, 16);
 						}
 
-						cmd.eal += 8;
-						cmd.size -= 8;
 						no_updates = 0;
 
-						if (item.sb & 0x8000)
+						if (stall)
 						{
 							spu.ch_stall_stat.push_or(spu, 1 << cmd.tag);
 
@@ -206,45 +191,33 @@ void mfc_thread::cpu_task()
 					spu.do_dma_transfer(cmd);
 					cmd.size = 0;
 				}
-				else if (UNLIKELY((cmd.cmd & ~0xc) == MFC_BARRIER_CMD))
+				else if (UNLIKELY(cmd.cmd == MFC_SYNC_CMD))
 				{
-					// TODO (MFC_BARRIER_CMD, MFC_EIEIO_CMD, MFC_SYNC_CMD)
+					// Barrier and EIEIO are satisfied by in-order execution
 					_mm_mfence();
 				}
 
 				if (!cmd.size)
 				{
+					spu.mfc_tag_count[cmd.tag & 0x1f]--;
 					spu.mfc_queue.end_pop();
 					no_updates = 0;
+
+					// Wake up the SPU thread waiting for a free slot
+					if (queue_size >= 16)
+					{
+						spu.notify();
+					}
 				}
 			}
 
 			test_state();
 
-			if (spu.ch_tag_upd)
+			if (const u32 upd = spu.ch_tag_upd)
 			{
-				// Mask incomplete transfers
-				u32 completed = spu.ch_tag_mask;
-
-				for (u32 i = 0; i < spu.mfc_queue.size(); i++)
-				{
-					const auto& _cmd = spu.mfc_queue[i];
-
-					if (_cmd.size)
-					{
-						if (spu.ch_tag_upd == 1)
-						{
-							completed &= ~(1u << _cmd.tag);
-						}
-						else
-						{
-							completed = 0;
-							break;
-						}
-					}
-				}
+				const u32 completed = spu.get_mfc_completed();
 
-				if (completed && spu.ch_tag_upd.exchange(0))
+				if (completed && (upd == MFC_TAG_UPDATE_ANY || completed == spu.ch_tag_mask) && spu.ch_tag_upd.exchange(0))
 				{
 					spu.ch_tag_stat.push(spu, completed);
 					no_updates = 0;
@@ -283,12 +256,6 @@ void mfc_thread::cpu_task()
 							break;
 						}
 					}
-
-					if (spu.ch_tag_upd)
-					{
-						no_updates = 0;
-						break;
-					}
 				}
 
 				if (no_updates)
@@ -93,6 +93,14 @@ struct alignas(16) spu_mfc_cmd
 	u32 eah;
 };
 
+// MFC list element
+struct spu_mfc_list_element
+{
+	be_t<u16> sb; // Stall-and-Notify bit (0x8000)
+	be_t<u16> ts; // List Transfer Size
+	be_t<u32> ea; // External Address Low
+};
+
 class mfc_thread : public cpu_thread
 {
 	using spu_ptr = std::shared_ptr<class SPUThread>;
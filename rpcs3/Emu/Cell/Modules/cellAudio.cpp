@@ -1,5 +1,6 @@
 #include "stdafx.h"
 #include "Utilities/Config.h"
+#include "Utilities/GSL.h"
 #include "Emu/System.h"
 #include "Emu/IdManager.h"
 #include "Emu/Cell/PPUModule.h"
@@ -16,6 +17,161 @@ logs::channel cellAudio("cellAudio", logs::level::notice);
 cfg::bool_entry g_cfg_audio_dump_to_file(cfg::root.audio, "Dump to file");
 cfg::bool_entry g_cfg_audio_convert_to_u16(cfg::root.audio, "Convert to 16 bit");
 
+// Load 4 big-endian floats
+static inline __m128 audio_load_be(const be_t<f32>* src)
+{
+	const auto mask = _mm_set_epi8(12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3);
+	return _mm_castsi128_ps(_mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src)), mask));
+}
+
+// Store 4 big-endian floats
+static inline void audio_store_be(be_t<f32>* dst, __m128 value)
+{
+	const auto mask = _mm_set_epi8(12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3);
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _mm_shuffle_epi8(_mm_castps_si128(value), mask));
+}
+
+// Get volume for two sample frames as (v0, v0, v1, v1)
+static inline __m128 audio_load_levels_2ch(const float* levels)
+{
+	const __m128 v = _mm_castsi128_ps(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(levels)));
+	return _mm_unpacklo_ps(v, v);
+}
+
+// Mix 2-channel port block (First: overwrite the buffers)
+template<bool First>
+static void audio_mix_2ch(float* buf2ch, float* buf8ch, const be_t<f32>* src, const float* levels)
+{
+	const __m128 zero = _mm_setzero_ps();
+
+	for (u32 i = 0; i < AUDIO_SAMPLES; i += 2)
+	{
+		const __m128 lr = _mm_mul_ps(audio_load_be(src + i * 2), audio_load_levels_2ch(levels + i));
+		const __m128 lr0 = _mm_movelh_ps(lr, zero);
+		const __m128 lr1 = _mm_movehl_ps(zero, lr);
+
+		float* const out2 = buf2ch + i * 2;
+		float* const out8 = buf8ch + i * 8;
+
+		if (First)
+		{
+			_mm_store_ps(out2, lr);
+			_mm_store_ps(out8 + 0, lr0);
+			_mm_store_ps(out8 + 4, zero);
+			_mm_store_ps(out8 + 8, lr1);
+			_mm_store_ps(out8 + 12, zero);
+		}
+		else
+		{
+			_mm_store_ps(out2, _mm_add_ps(_mm_load_ps(out2), lr));
+			_mm_store_ps(out8 + 0, _mm_add_ps(_mm_load_ps(out8 + 0), lr0));
+			_mm_store_ps(out8 + 8, _mm_add_ps(_mm_load_ps(out8 + 8), lr1));
+		}
+	}
+}
+
+// Mix 8-channel port block and downmix it to 2 channels (First: overwrite the buffers)
+template<bool First>
+static void audio_mix_8ch(float* buf2ch, float* buf8ch, const be_t<f32>* src, const float* levels)
+{
+	const __m128 mid_scale = _mm_set1_ps(0.708f);
+
+	for (u32 i = 0; i < AUDIO_SAMPLES; i += 2)
+	{
+		const __m128 v0 = _mm_set1_ps(levels[i + 0]);
+		const __m128 v1 = _mm_set1_ps(levels[i + 1]);
+
+		// (left, right, center, low_freq), (rear_left, rear_right, side_left, side_right)
+		const __m128 a0 = _mm_mul_ps(audio_load_be(src + i * 8 + 0), v0);
+		const __m128 b0 = _mm_mul_ps(audio_load_be(src + i * 8 + 4), v0);
+		const __m128 a1 = _mm_mul_ps(audio_load_be(src + i * 8 + 8), v1);
+		const __m128 b1 = _mm_mul_ps(audio_load_be(src + i * 8 + 12), v1);
+
+		// Downmix both frames: left + rear_left + side_left + (center + low_freq) * 0.708
+		const __m128 front = _mm_movelh_ps(a0, a1);
+		const __m128 rear = _mm_movelh_ps(b0, b1);
+		const __m128 side = _mm_movehl_ps(b1, b0);
+		const __m128 cl = _mm_movehl_ps(a1, a0);
+		const __m128 mid = _mm_mul_ps(_mm_add_ps(cl, _mm_shuffle_ps(cl, cl, _MM_SHUFFLE(2, 3, 0, 1))), mid_scale);
+		const __m128 lr = _mm_add_ps(_mm_add_ps(_mm_add_ps(front, rear), side), mid);
+
+		float* const out2 = buf2ch + i * 2;
+		float* const out8 = buf8ch + i * 8;
+
+		if (First)
+		{
+			_mm_store_ps(out2, lr);
+			_mm_store_ps(out8 + 0, a0);
+			_mm_store_ps(out8 + 4, b0);
+			_mm_store_ps(out8 + 8, a1);
+			_mm_store_ps(out8 + 12, b1);
+		}
+		else
+		{
+			_mm_store_ps(out2, _mm_add_ps(_mm_load_ps(out2), lr));
+			_mm_store_ps(out8 + 0, _mm_add_ps(_mm_load_ps(out8 + 0), a0));
+			_mm_store_ps(out8 + 4, _mm_add_ps(_mm_load_ps(out8 + 4), b0));
+			_mm_store_ps(out8 + 8, _mm_add_ps(_mm_load_ps(out8 + 8), a1));
+			_mm_store_ps(out8 + 12, _mm_add_ps(_mm_load_ps(out8 + 12), b1));
+		}
+	}
+}
+
+// Lock-free ring of mixed blocks (single producer: audio thread, single consumer: output thread)
+class audio_ring
+{
+	static const u32 s_count = BUFFER_NUM;
+
+	std::unique_ptr<float[]> m_data[s_count];
+	u32 m_size[s_count]{};
+
+	atomic_t<u32> m_read{0};
+	atomic_t<u32> m_write{0};
+
+public:
+	audio_ring(std::size_t block_size)
+	{
+		for (auto& data : m_data)
+		{
+			data.reset(new float[block_size]{});
+		}
+	}
+
+	// Get the block to fill (nullptr if the ring is full)
+	void* get_free() const
+	{
+		const u32 pos = m_write.load();
+		return pos - m_read.load() < s_count ? m_data[pos % s_count].get() : nullptr;
+	}
+
+	// Publish the block obtained with get_free()
+	void push(u32 size)
+	{
+		m_size[m_write.load() % s_count] = size;
+		m_write++;
+	}
+
+	// Get the oldest block (nullptr if the ring is empty)
+	const void* get_next(u32& size) const
+	{
+		const u32 pos = m_read.load();
+
+		if (pos == m_write.load())
+		{
+			return nullptr;
+		}
+
+		size = m_size[pos % s_count];
+		return m_data[pos % s_count].get();
+	}
+
+	// Release the block obtained with get_next()
+	void pop()
+	{
+		m_read++;
+	}
+};
+
 void audio_config::on_init(const std::shared_ptr<void>& _this)
 {
 	m_buffer.set(vm::alloc(AUDIO_PORT_OFFSET * AUDIO_PORT_COUNT, vm::main));
@@ -35,21 +191,46 @@ void audio_config::on_task()
 {
 	AudioDumper m_dump(g_cfg_audio_dump_to_file ? 2 : 0); // Init AudioDumper for 2 channels if enabled
 
-	float buf2ch[2 * BUFFER_SIZE]{}; // intermediate buffer for 2 channels
-	float buf8ch[8 * BUFFER_SIZE]{}; // intermediate buffer for 8 channels
+	alignas(16) float buf2ch[2 * BUFFER_SIZE]{}; // intermediate buffer for 2 channels
+	alignas(16) float buf8ch[8 * BUFFER_SIZE]{}; // intermediate buffer for 8 channels
 
-	static const size_t out_buffer_size = 8 * BUFFER_SIZE; // output buffer for 8 channels
+	alignas(16) float levels[AUDIO_SAMPLES]; // port volume for every sample frame
 
-	std::unique_ptr<float[]> out_buffer[BUFFER_NUM];
+	static const size_t out_buffer_size = 8 * BUFFER_SIZE; // output buffer for 8 channels
 
-	for (u32 i = 0; i < BUFFER_NUM; i++)
-	{
-		out_buffer[i].reset(new float[out_buffer_size] {});
-	}
+	audio_ring out_ring(out_buffer_size);
 
 	const auto audio = Emu.GetCallbacks().get_audio();
 	audio->Open(buf8ch, out_buffer_size * (g_cfg_audio_convert_to_u16 ? 2 : 4));
 
+	atomic_t<bool> out_stop{false};
+
+	// Feed the backend from a separate thread, so the mixer timing doesn't depend on it
+	scope_thread out_thread("Audio Output Thread", [&]()
+	{
+		while (!out_stop)
+		{
+			u32 size;
+
+			if (const void* data = out_ring.get_next(size))
+			{
+				audio->AddData(data, size);
+				out_ring.pop();
+				continue;
+			}
+
+			thread_ctrl::wait_for(1000);
+		}
+	});
+
+	auto at_ret = gsl::finally([&]()
+	{
+		out_stop = true;
+		out_thread.get()->notify();
+	});
+
+	u64 dropped = 0;
+
 	while (fxm::check<audio_config>() && !Emu.IsStopped())
 	{
 		if (Emu.IsPaused())
@@ -74,8 +255,6 @@ void audio_config::on_task()
 
 		m_counter++;
 
-		const u32 out_pos = m_counter % BUFFER_NUM;
-
 		bool first_mix = true;
 
 		// mixing:
@@ -89,9 +268,6 @@ void audio_config::on_task()
 
 			auto buf = vm::_ptr<f32>(buf_addr);
 
-			static const float k = 1.0f; // may be 1.0f
-			const float& m = port.level;
-
 			auto step_volume = [](audio_port& port) // part of cellAudioSetPortLevel functionality
 			{
 				const auto param = port.level_set.load();
@@ -109,109 +285,34 @@ void audio_config::on_task()
 				}
 			};
 
+			for (u32 i = 0; i < AUDIO_SAMPLES; i++)
+			{
+				step_volume(port);
+				levels[i] = port.level;
+			}
+
 			if (port.channel == 2)
 			{
 				if (first_mix)
 				{
-					for (u32 i = 0; i < (sizeof(buf2ch) / sizeof(float)); i += 2)
-					{
-						step_volume(port);
-
-						// reverse byte order
-						const float left = buf[i + 0] * m;
-						const float right = buf[i + 1] * m;
-
-						buf2ch[i + 0] = left;
-						buf2ch[i + 1] = right;
-
-						buf8ch[i * 4 + 0] = left;
-						buf8ch[i * 4 + 1] = right;
-						buf8ch[i * 4 + 2] = 0.0f;
-						buf8ch[i * 4 + 3] = 0.0f;
-						buf8ch[i * 4 + 4] = 0.0f;
-						buf8ch[i * 4 + 5] = 0.0f;
-						buf8ch[i * 4 + 6] = 0.0f;
-						buf8ch[i * 4 + 7] = 0.0f;
-					}
+					audio_mix_2ch<true>(buf2ch, buf8ch, buf, levels);
 					first_mix = false;
 				}
 				else
 				{
-					for (u32 i = 0; i < (sizeof(buf2ch) / sizeof(float)); i += 2)
-					{
-						step_volume(port);
-
-						const float left = buf[i + 0] * m;
-						const float right = buf[i + 1] * m;
-
-						buf2ch[i + 0] += left;
-						buf2ch[i + 1] += right;
-
-						buf8ch[i * 4 + 0] += left;
-						buf8ch[i * 4 + 1] += right;
-					}
+					audio_mix_2ch<false>(buf2ch, buf8ch, buf, levels);
 				}
 			}
 			else if (port.channel == 8)
 			{
 				if (first_mix)
 				{
-					for (u32 i = 0; i < (sizeof(buf2ch) / sizeof(float)); i += 2)
-					{
-						step_volume(port);
-
-						const float left = buf[i * 4 + 0] * m;
-						const float right = buf[i * 4 + 1] * m;
-						const float center = buf[i * 4 + 2] * m;
-						const float low_freq = buf[i * 4 + 3] * m;
-						const float rear_left = buf[i * 4 + 4] * m;
-						const float rear_right = buf[i * 4 + 5] * m;
-						const float side_left = buf[i * 4 + 6] * m;
-						const float side_right = buf[i * 4 + 7] * m;
-
-						const float mid = (center + low_freq) * 0.708f;
-						buf2ch[i + 0] = (left + rear_left + side_left + mid) * k;
-						buf2ch[i + 1] = (right + rear_right + side_right + mid) * k;
-
-						buf8ch[i * 4 + 0] = left;
-						buf8ch[i * 4 + 1] = right;
-						buf8ch[i * 4 + 2] = center;
-						buf8ch[i * 4 + 3] = low_freq;
-						buf8ch[i * 4 + 4] = rear_left;
-						buf8ch[i * 4 + 5] = rear_right;
-						buf8ch[i * 4 + 6] = side_left;
-						buf8ch[i * 4 + 7] = side_right;
-					}
+					audio_mix_8ch<true>(buf2ch, buf8ch, buf, levels);
 					first_mix = false;
 				}
 				else
 				{
-					for (u32 i = 0; i < (sizeof(buf2ch) / sizeof(float)); i += 2)
-					{
-						step_volume(port);
-
-						const float left = buf[i * 4 + 0] * m;
-						const float right = buf[i * 4 + 1] * m;
-						const float center = buf[i * 4 + 2] * m;
-						const float low_freq = buf[i * 4 + 3] * m;
-						const float rear_left = buf[i * 4 + 4] * m;
-						const float rear_right = buf[i * 4 + 5] * m;
-						const float side_left = buf[i * 4 + 6] * m;
-						const float side_right = buf[i * 4 + 7] * m;
-
-						const float mid = (center + low_freq) * 0.708f;
-						buf2ch[i + 0] += (left + rear_left + side_left + mid) * k;
-						buf2ch[i + 1] += (right + rear_right + side_right + mid) * k;
-
-						buf8ch[i * 4 + 0] += left;
-						buf8ch[i * 4 + 1] += right;
-						buf8ch[i * 4 + 2] += center;
-						buf8ch[i * 4 + 3] += low_freq;
-						buf8ch[i * 4 + 4] += rear_left;
-						buf8ch[i * 4 + 5] += rear_right;
-						buf8ch[i * 4 + 6] += side_left;
-						buf8ch[i * 4 + 7] += side_right;
-					}
+					audio_mix_8ch<false>(buf2ch, buf8ch, buf, levels);
 				}
 			}
 			else
@@ -223,51 +324,53 @@ void audio_config::on_task()
 		}
 
 
-		if (!first_mix)
-		{
-			// copy output data (2 ch)
-			//for (u32 i = 0; i < (sizeof(buf2ch) / sizeof(float)); i++)
-			//{
-			//	out_buffer[out_pos][i] = buf2ch[i];
-			//}
-
-			// copy output data (8 ch)
-			for (u32 i = 0; i < (sizeof(buf8ch) / sizeof(float)); i++)
-			{
-				out_buffer[out_pos][i] = buf8ch[i];
-			}
-		}
-
 		const u64 stamp1 = get_system_time();
 
 		if (first_mix)
 		{
-			memset(out_buffer[out_pos].get(), 0, out_buffer_size * sizeof(float));
+			std::memset(buf2ch, 0, sizeof(buf2ch));
+			std::memset(buf8ch, 0, sizeof(buf8ch));
 		}
 
-		if (g_cfg_audio_convert_to_u16)
+		if (void* out = out_ring.get_free())
 		{
-			// convert the data from float to u16 with clipping:
-			// 2x MULPS
-			// 2x MAXPS (optional)
-			// 2x MINPS (optional)
-			// 2x CVTPS2DQ (converts float to s32)
-			// PACKSSDW (converts s32 to s16 with signed saturation)
-
-			u16 buf_u16[out_buffer_size];
-			for (size_t i = 0; i < out_buffer_size; i += 8)
+			if (g_cfg_audio_convert_to_u16)
 			{
+				// convert the data from float to u16 with clipping:
+				// 2x MAXPS, 2x MINPS
+				// 2x MULPS
+				// 2x CVTPS2DQ (converts float to s32)
+				// PACKSSDW (converts s32 to s16 with signed saturation)
+
+				const auto min = _mm_set1_ps(-1.0f);
+				const auto max = _mm_set1_ps(1.0f);
 				const auto scale = _mm_set1_ps(0x8000);
-				(__m128i&)(buf_u16[i]) = _mm_packs_epi32(
-					_mm_cvtps_epi32(_mm_mul_ps(_mm_load_ps(out_buffer[out_pos].get() + i), scale)),
-					_mm_cvtps_epi32(_mm_mul_ps(_mm_load_ps(out_buffer[out_pos].get() + i + 4), scale)));
+
+				u16* const buf_u16 = static_cast<u16*>(out);
+
+				for (size_t i = 0; i < out_buffer_size; i += 8)
+				{
+					const auto v0 = _mm_min_ps(_mm_max_ps(_mm_load_ps(buf8ch + i), min), max);
+					const auto v1 = _mm_min_ps(_mm_max_ps(_mm_load_ps(buf8ch + i + 4), min), max);
+
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(buf_u16 + i), _mm_packs_epi32(
+						_mm_cvtps_epi32(_mm_mul_ps(v0, scale)),
+						_mm_cvtps_epi32(_mm_mul_ps(v1, scale))));
+				}
+
+				out_ring.push(out_buffer_size * sizeof(u16));
+			}
+			else
+			{
+				std::memcpy(out, buf8ch, sizeof(buf8ch));
+				out_ring.push(out_buffer_size * sizeof(float));
 			}
 
-			audio->AddData(buf_u16, out_buffer_size * sizeof(u16));
+			out_thread.get()->notify();
 		}
-		else
+		else if (!dropped++)
 		{
-			audio->AddData(out_buffer[out_pos].get(), out_buffer_size * sizeof(float));
+			cellAudio.warning("Audio output is too slow, dropping blocks");
 		}
 
 		const u64 stamp2 = get_system_time();
@@ -803,9 +906,12 @@ s32 cellAudioAddData(u32 portNum, vm::ptr<float> src, u32 samples, float volume)
 
 	const auto dst = vm::ptr<float>::make(port.addr.addr() + u32(port.tag % port.block) * port.channel * 256 * SIZE_32(float));
 
-	for (u32 i = 0; i < samples * port.channel; i++)
+	const __m128 vol = _mm_set1_ps(volume);
+
+	// mix all channels (the block size is a multiple of 4)
+	for (u32 i = 0; i < samples * port.channel; i += 4)
 	{
-		dst[i] += src[i] * volume; // mix all channels
+		audio_store_be(dst.get_ptr() + i, _mm_add_ps(audio_load_be(dst.get_ptr() + i), _mm_mul_ps(audio_load_be(src.get_ptr() + i), vol)));
 	}
 
 	return CELL_OK;
@@ -842,30 +948,22 @@ s32 cellAudioAdd2chData(u32 portNum, vm::ptr<float> src, u32 samples, float volu
 	{
 		cellAudio.error("cellAudioAdd2chData(portNum=%d): port.channel = 2", portNum);
 	}
-	else if (port.channel == 6)
+	else if (port.channel == 6 || port.channel == 8)
 	{
-		for (u32 i = 0; i < samples; i++)
-		{
-			dst[i * 6 + 0] += src[i * 2 + 0] * volume; // mix L ch
-			dst[i * 6 + 1] += src[i * 2 + 1] * volume; // mix R ch
-			//dst[i * 6 + 2] += 0.0f; // center
-			//dst[i * 6 + 3] += 0.0f; // LFE
-			//dst[i * 6 + 4] += 0.0f; // rear L
-			//dst[i * 6 + 5] += 0.0f; // rear R
-		}
-	}
-	else if (port.channel == 8)
-	{
-		for (u32 i = 0; i < samples; i++)
+		const __m128 vol = _mm_set1_ps(volume);
+		const __m128 zero = _mm_setzero_ps();
+		const u32 ch = port.channel;
+
+		// mix L and R ch of two sample frames, other channels are unchanged (+0.0f)
+		for (u32 i = 0; i < samples; i += 2)
 		{
-			dst[i * 8 + 0] += src[i * 2 + 0] * volume; // mix L ch
-			dst[i * 8 + 1] += src[i * 2 + 1] * volume; // mix R ch
-			//dst[i * 8 + 2] += 0.0f; // center
-			//dst[i * 8 + 3] += 0.0f; // LFE
-			//dst[i * 8 + 4] += 0.0f; // rear L
-			//dst[i * 8 + 5] += 0.0f; // rear R
-			//dst[i * 8 + 6] += 0.0f; // side L
-			//dst[i * 8 + 7] += 0.0f; // side R
+			const __m128 lr = _mm_mul_ps(audio_load_be(src.get_ptr() + i * 2), vol);
+
+			be_t<f32>* const out0 = dst.get_ptr() + i * ch;
+			be_t<f32>* const out1 = out0 + ch;
+
+			audio_store_be(out0, _mm_add_ps(audio_load_be(out0), _mm_movelh_ps(lr, zero)));
+			audio_store_be(out1, _mm_add_ps(audio_load_be(out1), _mm_movehl_ps(zero, lr)));
 		}
 	}
 	else
@@ -902,16 +1000,23 @@ s32 cellAudioAdd6chData(u32 portNum, vm::ptr<float> src, float volume)
 	}
 	else if (port.channel == 8)
 	{
-		for (u32 i = 0; i < 256; i++)
+		const __m128 vol = _mm_set1_ps(volume);
+		const __m128 zero = _mm_setzero_ps();
+
+		// mix L, R, center, LFE, rear L and rear R ch (side channels are unchanged)
+		for (u32 i = 0; i < 256; i += 2)
 		{
-			dst[i * 8 + 0] += src[i * 6 + 0] * volume; // mix L ch
-			dst[i * 8 + 1] += src[i * 6 + 1] * volume; // mix R ch
-			dst[i * 8 + 2] += src[i * 6 + 2] * volume; // mix center
-			dst[i * 8 + 3] += src[i * 6 + 3] * volume; // mix LFE
-			dst[i * 8 + 4] += src[i * 6 + 4] * volume; // mix rear L
-			dst[i * 8 + 5] += src[i * 6 + 5] * volume; // mix rear R
-			//dst[i * 8 + 6] += 0.0f; // side L
-			//dst[i * 8 + 7] += 0.0f; // side R
+			// 12 floats of two sample frames
+			const __m128 s0 = _mm_mul_ps(audio_load_be(src.get_ptr() + i * 6 + 0), vol);
+			const __m128 s1 = _mm_mul_ps(audio_load_be(src.get_ptr() + i * 6 + 4), vol);
+			const __m128 s2 = _mm_mul_ps(audio_load_be(src.get_ptr() + i * 6 + 8), vol);
+
+			be_t<f32>* const out = dst.get_ptr() + i * 8;
+
+			audio_store_be(out + 0, _mm_add_ps(audio_load_be(out + 0), s0));
+			audio_store_be(out + 4, _mm_add_ps(audio_load_be(out + 4), _mm_movelh_ps(s1, zero)));
+			audio_store_be(out + 8, _mm_add_ps(audio_load_be(out + 8), _mm_shuffle_ps(s1, s2, _MM_SHUFFLE(1, 0, 3, 2))));
+			audio_store_be(out + 12, _mm_add_ps(audio_load_be(out + 12), _mm_movehl_ps(zero, s2)));
 		}
 	}
 	else
@@ -10,6 +10,9 @@
 #include "Utilities/StrUtil.h"
 
 #include <mutex>
+#include <deque>
+#include <thread>
+#include <unordered_map>
 
 namespace vm { using namespace ps3; }
 
@@ -617,52 +620,335 @@ struct lv2_fs_mount_point
 	std::mutex mutex;
 };
 
+struct fs_aio_request
+{
+	u32 type; // 1: read, 2: write
+	s32 xid;
+	vm::ptr<CellFsAio> aio;
+	fs_aio_cb_t func;
+	u32 fd;
+	u64 offset;
+	vm::ptr<void> buf;
+	u64 size;
+};
+
+struct fs_aio_result
+{
+	vm::ptr<CellFsAio> aio;
+	fs_aio_cb_t func;
+	s32 error;
+	s32 xid;
+	u64 size;
+};
+
+// Delivers completion callbacks to the guest
 struct fs_aio_thread : ppu_thread
 {
 	using ppu_thread::ppu_thread;
 
+	std::mutex mutex;
+
+	// Completed requests not delivered yet
+	std::vector<fs_aio_result> results;
+
 	virtual void cpu_task() override
 	{
+		std::vector<fs_aio_result> list;
+
 		while (cmd64 cmd = cmd_wait())
 		{
-			const u32 type = cmd.arg1<u32>();
-			const s32 xid = cmd.arg2<s32>();
-			const cmd64 cmd2 = cmd_get(1);
-			const auto aio = cmd2.arg1<vm::ptr<CellFsAio>>();
-			const auto func = cmd2.arg2<fs_aio_cb_t>();
-			cmd_pop(1);
-
-			s32 error = CELL_OK;
-			u64 result = 0;
+			cmd_pop();
 
-			const auto file = idm::get<lv2_fs_object, lv2_file>(aio->fd);
-
-			if (!file || (type == 1 && file->flags & CELL_FS_O_WRONLY) || (type == 2 && !(file->flags & CELL_FS_O_ACCMODE)))
 			{
-				error = CELL_EBADF;
+				std::lock_guard<std::mutex> lock(mutex);
+				list.swap(results);
 			}
-			else
+
+			for (const auto& r : list)
 			{
-				std::lock_guard<std::mutex> lock(file->mp->mutex);
+				r.func(*this, r.aio, r.error, r.xid, r.size);
+			}
+
+			list.clear();
+			lv2_obj::sleep(*this);
+		}
+	}
 
-				const auto old_pos = file->file.pos(); file->file.seek(aio->offset);
+	// Called by the I/O workers
+	void complete(std::vector<fs_aio_result>& list)
+	{
+		std::unique_lock<std::mutex> lock(mutex);
 
-				result = type == 2
-					? file->op_write(aio->buf, aio->size)
-					: file->op_read(aio->buf, aio->size);
+		const bool was_empty = results.empty();
+		results.insert(results.end(), list.begin(), list.end());
+		lock.unlock();
 
-				file->file.seek(old_pos);
-			}
+		if (was_empty)
+		{
+			// Wake up once for the whole batch
+			cmd_list
+			({
+				{ 1, 0 },
+			});
 
-			func(*this, aio, error, xid, result);
-			lv2_obj::sleep(*this);
+			notify();
 		}
 	}
 };
 
+// Host-side I/O worker pool
 struct fs_aio_manager
 {
+	// Max amount of adjacent reads merged into a single read
+	static const u32 merge_max_count = 16;
+
+	// Max size of merged read
+	static const u64 merge_max_size = 0x100000;
+
+	struct fd_state
+	{
+		u32 reads = 0;
+		bool writing = false;
+	};
+
 	std::shared_ptr<fs_aio_thread> thread;
+
+	std::vector<std::shared_ptr<thread_ctrl>> workers;
+
+	std::mutex mutex;
+
+	// Pending requests in submission order
+	std::deque<fs_aio_request> queue;
+
+	// Requests in progress
+	std::unordered_map<u32, fd_state> fds;
+
+	atomic_t<bool> stop{false};
+
+	~fs_aio_manager()
+	{
+		stop = true;
+
+		for (auto& worker : workers)
+		{
+			worker->notify();
+			worker->join();
+		}
+	}
+
+	void start()
+	{
+		const u32 count = std::max<u32>(std::min<u32>(std::thread::hardware_concurrency(), 4), 1);
+
+		for (u32 i = 0; i < count; i++)
+		{
+			workers.emplace_back();
+
+			thread_ctrl::spawn(workers.back(), fmt::format("FS AIO Worker %u", i), [this]()
+			{
+				std::vector<fs_aio_request> batch;
+				std::vector<fs_aio_result> results;
+				std::vector<u8> buffer;
+
+				while (!stop)
+				{
+					if (!pick(batch))
+					{
+						thread_ctrl::wait();
+						continue;
+					}
+
+					process(batch, results, buffer);
+					finish(batch);
+					thread->complete(results);
+
+					batch.clear();
+					results.clear();
+				}
+			});
+		}
+	}
+
+	void submit(const fs_aio_request& request)
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			queue.emplace_back(request);
+		}
+
+		for (auto& worker : workers)
+		{
+			worker->notify();
+		}
+	}
+
+	// Take the first request which can be started (with adjacent reads merged)
+	bool pick(std::vector<fs_aio_request>& batch)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+
+		// Writes are ordered with other requests to the same fd
+		std::vector<u32> blocked;
+
+		for (std::size_t i = 0; i < queue.size(); i++)
+		{
+			const u32 fd = queue[i].fd;
+			auto& state = fds[fd];
+
+			if (state.writing || std::count(blocked.begin(), blocked.end(), fd))
+			{
+				continue;
+			}
+
+			if (queue[i].type == 2)
+			{
+				if (state.reads)
+				{
+					blocked.emplace_back(fd);
+					continue;
+				}
+
+				state.writing = true;
+				batch.emplace_back(queue[i]);
+				queue.erase(queue.begin() + i);
+				return true;
+			}
+
+			state.reads++;
+			batch.emplace_back(queue[i]);
+			queue.erase(queue.begin() + i);
+
+			// Mapped files are read directly, merging doesn't help them
+			const auto file = idm::get<lv2_fs_object, lv2_file>(fd);
+
+			if (!file || file->mapped)
+			{
+				return true;
+			}
+
+			u64 total = batch[0].size;
+
+			for (std::size_t j = i; j < queue.size() && batch.size() < merge_max_count; j++)
+			{
+				if (queue[j].fd != fd)
+				{
+					continue;
+				}
+
+				if (queue[j].type == 2)
+				{
+					break;
+				}
+
+				if (queue[j].offset == batch.back().offset + batch.back().size && total + queue[j].size <= merge_max_size)
+				{
+					total += queue[j].size;
+					batch.emplace_back(queue[j]);
+					queue.erase(queue.begin() + j--);
+				}
+			}
+
+			return true;
+		}
+
+		return false;
+	}
+
+	void finish(const std::vector<fs_aio_request>& batch)
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+
+		const auto found = fds.find(batch[0].fd);
+
+		if (batch[0].type == 2)
+		{
+			found->second.writing = false;
+		}
+		else
+		{
+			found->second.reads--;
+		}
+
+		if (!found->second.reads && !found->second.writing)
+		{
+			fds.erase(found);
+		}
+
+		const bool pending = !queue.empty();
+		lock.unlock();
+
+		if (pending)
+		{
+			// Requests blocked by this one may be started now
+			for (auto& worker : workers)
+			{
+				worker->notify();
+			}
+		}
+	}
+
+	static void process(const std::vector<fs_aio_request>& batch, std::vector<fs_aio_result>& results, std::vector<u8>& buffer)
+	{
+		const auto& first = batch[0];
+		const u32 type = first.type;
+
+		const auto file = idm::get<lv2_fs_object, lv2_file>(first.fd);
+
+		if (!file || (type == 1 && file->flags & CELL_FS_O_WRONLY) || (type == 2 && !(file->flags & CELL_FS_O_ACCMODE)))
+		{
+			for (const auto& r : batch)
+			{
+				results.push_back({r.aio, r.func, static_cast<s32>(CELL_EBADF), r.xid, 0});
+			}
+
+			return;
+		}
+
+		if (batch.size() == 1)
+		{
+			u64 result = 0;
+
+			if (type == 2 || !file->op_read_at(first.offset, first.buf, first.size, result))
+			{
+				std::lock_guard<std::mutex> lock(file->mp->mutex);
+
+				const auto old_pos = file->file.pos(); file->file.seek(first.offset);
+
+				result = type == 2
+					? file->op_write(first.buf, first.size)
+					: file->op_read(first.buf, first.size);
+
+				file->file.seek(old_pos);
+			}
+
+			results.push_back({first.aio, first.func, CELL_OK, first.xid, result});
+			return;
+		}
+
+		// Merged read: single read of the whole range, then scatter
+		const u64 total = batch.back().offset + batch.back().size - first.offset;
+		buffer.resize(total);
+
+		u64 result = 0;
+
+		if (!file->file.read_at(first.offset, buffer.data(), total, result))
+		{
+			std::lock_guard<std::mutex> lock(file->mp->mutex);
+
+			const auto old_pos = file->file.pos(); file->file.seek(first.offset);
+			result = file->file.read(buffer.data(), total);
+			file->file.seek(old_pos);
+		}
+
+		for (const auto& r : batch)
+		{
+			const u64 pos = r.offset - first.offset;
+			const u64 size = pos < result ? std::min<u64>(r.size, result - pos) : 0;
+
+			std::memcpy(r.buf.get_ptr(), buffer.data() + pos, size);
+			results.push_back({r.aio, r.func, CELL_OK, r.xid, size});
+		}
+	}
 };
 
 s32 cellFsAioInit(vm::cptr<char> mount_point)
@@ -676,6 +962,7 @@ s32 cellFsAioInit(vm::cptr<char> mount_point)
 	{
 		m->thread = idm::make_ptr<ppu_thread, fs_aio_thread>("FS AIO Thread", 500);
 		m->thread->run();
+		m->start();
 	}
 
 	return CELL_OK;
@@ -707,13 +994,7 @@ s32 cellFsAioRead(vm::ptr<CellFsAio> aio, vm::ptr<s32> id, fs_aio_cb_t func)
 
 	const s32 xid = (*id = ++g_fs_aio_id);
 
-	m->thread->cmd_list
-	({
-		{ 1, xid },
-		{ aio, func },
-	});
-
-	m->thread->notify();
+	m->submit({1, xid, aio, func, aio->fd, aio->offset, aio->buf, aio->size});
 
 	return CELL_OK;
 }
@@ -733,13 +1014,7 @@ s32 cellFsAioWrite(vm::ptr<CellFsAio> aio, vm::ptr<s32> id, fs_aio_cb_t func)
 
 	const s32 xid = (*id = ++g_fs_aio_id);
 
-	m->thread->cmd_list
-	({
-		{ 2, xid },
-		{ aio, func },
-	});
-
-	m->thread->notify();
+	m->submit({2, xid, aio, func, aio->fd, aio->offset, aio->buf, aio->size});
 
 	return CELL_OK;
 }
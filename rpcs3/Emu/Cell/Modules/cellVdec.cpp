@@ -1,4 +1,5 @@
 #include "stdafx.h"
+#include "Utilities/Config.h"
 #include "Emu/System.h"
 #include "Emu/IdManager.h"
 #include "Emu/Cell/PPUModule.h"
@@ -22,6 +23,9 @@ std::mutex g_mutex_avcodec_open2;
 
 logs::channel cellVdec("cellVdec", logs::level::notice);
 
+// Frame threading increases decoding throughput, but pictures are returned with a delay of several AUs
+cfg::bool_entry g_cfg_vdec_frame_threading(cfg::root.video, "Frame-threaded Video Decoding");
+
 vm::gvar<s32> _cell_vdec_prx_ver; // ???
 
 enum class vdec_cmd : u32
@@ -35,14 +39,54 @@ enum class vdec_cmd : u32
 	close,
 };
 
+// Decoded frames are reused instead of being allocated for every picture
+struct vdec_frame_pool
+{
+	std::mutex mutex;
+	std::vector<AVFrame*> frames;
+
+	AVFrame* alloc()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+
+			if (!frames.empty())
+			{
+				AVFrame* result = frames.back();
+				frames.pop_back();
+				return result;
+			}
+		}
+
+		return av_frame_alloc();
+	}
+
+	void free(AVFrame* data)
+	{
+		av_frame_unref(data);
+
+		std::lock_guard<std::mutex> lock(mutex);
+		frames.push_back(data);
+	}
+
+	~vdec_frame_pool()
+	{
+		for (AVFrame* data : frames)
+		{
+			av_frame_free(&data);
+		}
+	}
+};
+
 struct vdec_frame
 {
 	struct frame_dtor
 	{
+		std::shared_ptr<vdec_frame_pool> pool;
+
 		void operator()(AVFrame* data) const
 		{
-			av_frame_unref(data);
-			av_frame_free(&data);
+			pool->free(data);
 		}
 	};
 
@@ -79,6 +123,14 @@ struct vdec_thread : ppu_thread
 	std::queue<vdec_frame> out;
 	u32 max_frames = 20;
 
+	const std::shared_ptr<vdec_frame_pool> frame_pool = std::make_shared<vdec_frame_pool>();
+
+	// Picture converter (reused while the formats and the size don't change)
+	std::mutex sws_mutex;
+	SwsContext* sws{};
+	std::vector<u8> alpha_plane;
+	u8 alpha_value{};
+
 	vdec_thread(s32 type, u32 profile, u32 addr, u32 size, vm::ptr<CellVdecCbMsg> func, u32 arg, u32 prio, u32 stack)
 		: ppu_thread("HLE Video Decoder", prio, stack)
 		, type(type)
@@ -125,6 +177,20 @@ struct vdec_thread : ppu_thread
 			fmt::throw_exception("avcodec_alloc_context3() failed (type=0x%x)" HERE, type);
 		}
 
+		// Use automatic thread count, MPEG4 doesn't support slice threading
+		ctx->thread_count = 0;
+		ctx->thread_type = type == CELL_VDEC_CODEC_TYPE_DIVX ? 0 : FF_THREAD_SLICE;
+
+		if (g_cfg_vdec_frame_threading)
+		{
+			ctx->thread_type |= FF_THREAD_FRAME;
+		}
+
+		if (!ctx->thread_type)
+		{
+			ctx->thread_count = 1;
+		}
+
 		AVDictionary* opts{};
 		av_dict_set(&opts, "refcounted_frames", "1", 0);
 
@@ -142,6 +208,7 @@ struct vdec_thread : ppu_thread
 	{
 		avcodec_close(ctx);
 		avcodec_free_context(&ctx);
+		sws_freeContext(sws);
 	}
 
 	virtual std::string dump() const override
@@ -220,7 +287,7 @@ struct vdec_thread : ppu_thread
 				while (max_frames)
 				{
 					vdec_frame frame;
-					frame.avf.reset(av_frame_alloc());
+					frame.avf = {frame_pool->alloc(), vdec_frame::frame_dtor{frame_pool}};
 
 					if (!frame.avf)
 					{
@@ -559,12 +626,12 @@ s32 cellVdecGetPicture(u32 handle, vm::cptr<CellVdecPicFormat> format, vm::ptr<u
 
 		AVPixelFormat out_f = AV_PIX_FMT_YUV420P;
 
-		std::unique_ptr<u8[]> alpha_plane;
+		bool alpha = false;
 
 		switch (const u32 type = format->formatType)
 		{
-		case CELL_VDEC_PICFMT_ARGB32_ILV: out_f = AV_PIX_FMT_ARGB; alpha_plane.reset(new u8[w * h]); break;
-		case CELL_VDEC_PICFMT_RGBA32_ILV: out_f = AV_PIX_FMT_RGBA; alpha_plane.reset(new u8[w * h]); break;
+		case CELL_VDEC_PICFMT_ARGB32_ILV: out_f = AV_PIX_FMT_ARGB; alpha = true; break;
+		case CELL_VDEC_PICFMT_RGBA32_ILV: out_f = AV_PIX_FMT_RGBA; alpha = true; break;
 		case CELL_VDEC_PICFMT_UYVY422_ILV: out_f = AV_PIX_FMT_UYVY422; break;
 		case CELL_VDEC_PICFMT_YUV420_PLANAR: out_f = AV_PIX_FMT_YUV420P; break;
 
@@ -580,16 +647,11 @@ s32 cellVdecGetPicture(u32 handle, vm::cptr<CellVdecPicFormat> format, vm::ptr<u
 			fmt::throw_exception("Unknown colorMatrixType (%d)" HERE, format->colorMatrixType);
 		}
 
-		if (alpha_plane)
-		{
-			std::memset(alpha_plane.get(), format->alpha, w * h);
-		}
-
 		AVPixelFormat in_f = AV_PIX_FMT_YUV420P;
 
 		switch (frame->format)
 		{
-		case AV_PIX_FMT_YUV420P: in_f = alpha_plane ? AV_PIX_FMT_YUVA420P : AV_PIX_FMT_YUV420P; break;
+		case AV_PIX_FMT_YUV420P: in_f = alpha ? AV_PIX_FMT_YUVA420P : AV_PIX_FMT_YUV420P; break;
 
 		default:
 		{
@@ -597,14 +659,54 @@ s32 cellVdecGetPicture(u32 handle, vm::cptr<CellVdecPicFormat> format, vm::ptr<u
 		}
 		}
 
-		std::unique_ptr<SwsContext, void(*)(SwsContext*)> sws(sws_getContext(w, h, in_f, w, h, out_f, SWS_POINT, NULL, NULL, NULL), sws_freeContext);
+		u8* const out = outBuff.get_ptr();
+
+		if (in_f == out_f)
+		{
+			// Same layout: copy planes directly into the output buffer
+			const int plane_w[3] = { w, w / 2, w / 2 };
+			const int plane_h[3] = { h, h / 2, h / 2 };
+			u8* const out_data[3] = { out, out + w * h, out + w * h * 5 / 4 };
+
+			for (int i = 0; i < 3; i++)
+			{
+				if (frame->linesize[i] == plane_w[i])
+				{
+					std::memcpy(out_data[i], frame->data[i], plane_w[i] * plane_h[i]);
+					continue;
+				}
+
+				for (int y = 0; y < plane_h[i]; y++)
+				{
+					std::memcpy(out_data[i] + y * plane_w[i], frame->data[i] + y * frame->linesize[i], plane_w[i]);
+				}
+			}
+
+			return CELL_OK;
+		}
+
+		std::lock_guard<std::mutex> lock(vdec->sws_mutex);
+
+		vdec->sws = sws_getCachedContext(vdec->sws, w, h, in_f, w, h, out_f, SWS_POINT, NULL, NULL, NULL);
+
+		if (!vdec->sws)
+		{
+			fmt::throw_exception("sws_getCachedContext() failed (%dx%d, format=%d)" HERE, w, h, (s32)out_f);
+		}
+
+		if (alpha && (vdec->alpha_plane.size() < std::size_t(w * h) || vdec->alpha_value != format->alpha))
+		{
+			vdec->alpha_plane.resize(std::max<std::size_t>(vdec->alpha_plane.size(), w * h));
+			vdec->alpha_value = format->alpha;
+			std::memset(vdec->alpha_plane.data(), vdec->alpha_value, vdec->alpha_plane.size());
+		}
 
-		u8* in_data[4] = { frame->data[0], frame->data[1], frame->data[2], alpha_plane.get() };
+		u8* in_data[4] = { frame->data[0], frame->data[1], frame->data[2], alpha ? vdec->alpha_plane.data() : nullptr };
 		int in_line[4] = { frame->linesize[0], frame->linesize[1], frame->linesize[2], w * 1 };
-		u8* out_data[4] = { outBuff.get_ptr() };
+		u8* out_data[4] = { out };
 		int out_line[4] = { w * 4 };
 
-		if (!alpha_plane)
+		if (!alpha)
 		{
 			out_data[1] = out_data[0] + w * h;
 			out_data[2] = out_data[0] + w * h * 5 / 4;
@@ -613,7 +715,7 @@ s32 cellVdecGetPicture(u32 handle, vm::cptr<CellVdecPicFormat> format, vm::ptr<u
 			out_line[2] = w / 2;
 		}
 
-		sws_scale(sws.get(), in_data, in_line, 0, h, out_data, out_line);
+		sws_scale(vdec->sws, in_data, in_line, 0, h, out_data, out_line);
 
 		//const u32 buf_size = align(av_image_get_buffer_size(vdec->ctx->pix_fmt, vdec->ctx->width, vdec->ctx->height, 1), 128);
 
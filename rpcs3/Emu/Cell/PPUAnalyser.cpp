@@ -2,6 +2,7 @@
 #include "PPUOpcodes.h"
 #include "PPUModule.h"
 #include "PPUAnalyser.h"
+#include "Utilities/Thread.h"
 
 #include <unordered_set>
 
@@ -152,6 +153,12 @@ static u32 ppu_test(vm::cptr<u32> ptr, vm::cptr<void> fend, ppu_pattern_matrix p
 	return 0;
 }
 
+// Amount of memory scanned by a single task
+static const u32 ppu_scan_task_size = 0x100000;
+
+// Amount of functions processed by a single task
+static const u32 ppu_func_task_size = 0x400;
+
 namespace ppu_patterns
 {
 	using namespace ppu_instructions;
@@ -341,6 +348,116 @@ std::vector<ppu_function> ppu_analyse(const std::vector<std::pair<u32, u32>>& se
 	// Function analysis workload
 	std::vector<std::reference_wrapper<ppu_function>> func_queue;
 
+	// Segment scanning tasks
+	struct scan_task
+	{
+		u32 seg; // Segment index
+		u32 addr; // First word
+		u32 end; // Scanning limit
+		u32 index; // Sequence number of the first word in full scan order
+	};
+
+	std::vector<scan_task> scan_tasks;
+
+	for (u32 i = 0, index = 0; i < segs.size(); i++)
+	{
+		for (u32 pos = 0; pos < segs[i].second; pos += ppu_scan_task_size)
+		{
+			scan_tasks.push_back({i, segs[i].first + pos, segs[i].first + std::min<u32>(segs[i].second, pos + ppu_scan_task_size), index + pos / 4});
+		}
+
+		index += (segs[i].second + 3) / 4;
+	}
+
+	// Aligned values pointing to the executable segment (value, sequence number), sorted
+	std::vector<std::pair<u32, u32>> ptr_values;
+
+	// Possible OPD entry: aligned value pointing to the executable segment followed by TOC
+	struct opd_candidate
+	{
+		u32 toc;
+		u32 seq; // Sequence number in full scan order
+		u32 addr;
+		u32 seg;
+
+		bool operator <(const opd_candidate& rhs) const
+		{
+			return toc < rhs.toc || (toc == rhs.toc && seq < rhs.seq);
+		}
+	};
+
+	// OPD candidates sorted by TOC
+	std::vector<opd_candidate> opd_values;
+
+	bool values_ready = false;
+
+	// Scan all segments once (they aren't modified during analysis)
+	auto scan_values = [&]()
+	{
+		if (values_ready)
+		{
+			return;
+		}
+
+		std::vector<std::vector<std::pair<u32, u32>>> ptr_parts(scan_tasks.size());
+		std::vector<std::vector<opd_candidate>> opd_parts(scan_tasks.size());
+
+		run_parallel("PPU Analyser", ::size32(scan_tasks), [&](u32 index)
+		{
+			const auto& task = scan_tasks[index];
+
+			u32 seq = task.index;
+
+			for (vm::cptr<u32> ptr = vm::cast(task.addr); ptr.addr() < task.end; ptr++, seq++)
+			{
+				const u32 value = ptr[0];
+
+				if (value % 4 == 0 && value >= start && value < end)
+				{
+					ptr_parts[index].emplace_back(value, seq);
+
+					// The TOC word may lie past the end of the segment
+					if (ptr.addr() + 4 < segs[task.seg].first + segs[task.seg].second || vm::check_addr(ptr.addr() + 4, 4))
+					{
+						opd_parts[index].push_back({ptr[1], seq, ptr.addr(), task.seg});
+					}
+				}
+			}
+
+			std::sort(ptr_parts[index].begin(), ptr_parts[index].end());
+			std::sort(opd_parts[index].begin(), opd_parts[index].end());
+		});
+
+		// Merge sorted parts pairwise
+		const auto merge = [](auto& parts, auto& result)
+		{
+			for (u32 step = 1; step < parts.size(); step *= 2)
+			{
+				run_parallel("PPU Analyser", ::size32(parts) / (step * 2) + (::size32(parts) % (step * 2) > step), [&](u32 index)
+				{
+					auto& left = parts[index * step * 2];
+					auto& right = parts[index * step * 2 + step];
+
+					std::remove_reference_t<decltype(left)> merged;
+					merged.reserve(left.size() + right.size());
+					std::merge(left.begin(), left.end(), right.begin(), right.end(), std::back_inserter(merged));
+
+					left = std::move(merged);
+					right = {};
+				});
+			}
+
+			if (!parts.empty())
+			{
+				result = std::move(parts[0]);
+			}
+		};
+
+		merge(ptr_parts, ptr_values);
+		merge(opd_parts, opd_values);
+		values_ready = true;
+	};
+
 	// Register new function
 	auto add_func = [&](u32 addr, u32 toc, u32 origin) -> ppu_function&
 	{
@@ -377,19 +494,31 @@ std::vector<ppu_function> ppu_analyse(const std::vector<std::pair<u32, u32>>& se
 			return;
 		}
 
-		// Grope for OPD section (TODO: optimization, better constraints)
-		for (const auto& seg : segs)
+		// Grope for OPD section (TODO: better constraints)
+		scan_values();
+
+		const auto found = std::equal_range(opd_values.begin(), opd_values.end(), opd_candidate{toc, 0, 0, 0}, [](const opd_candidate& l, const opd_candidate& r)
+		{
+			return l.toc < r.toc;
+		});
+
+		// Skip the word following the OPD entry (within the same segment)
+		u32 skip = -1;
+		u32 skip_seg = -1;
+
+		for (auto it = found.first; it != found.second; it++)
 		{
-			for (vm::cptr<u32> ptr = vm::cast(seg.first); ptr.addr() < seg.first + seg.second; ptr++)
+			if (it->addr == skip && it->seg == skip_seg)
 			{
-				if (ptr[0] >= start && ptr[0] < end && ptr[0] % 4 == 0 && ptr[1] == toc)
-				{
-					// New function
-					LOG_TRACE(PPU, "OPD*: [0x%x] 0x%x (TOC=0x%x)", ptr, ptr[0], ptr[1]);
-					add_func(*ptr, toc, ptr.addr());
-					ptr++;
-				}
+				continue;
 			}
+
+			// New function
+			const vm::cptr<u32> ptr = vm::cast(it->addr);
+			LOG_TRACE(PPU, "OPD*: [0x%x] 0x%x (TOC=0x%x)", ptr, ptr[0], ptr[1]);
+			add_func(*ptr, toc, ptr.addr());
+			skip = it->addr + 4;
+			skip_seg = it->seg;
 		}
 	};
 
@@ -808,18 +937,21 @@ std::vector<ppu_function> ppu_analyse(const std::vector<std::pair<u32, u32>>& se
 			// Get limit
 			const u32 func_end2 = _next == funcs.end() ? func_end : std::min<u32>(_next->first, func_end);
 
-			// Find more block entries
-			for (const auto& seg : segs)
+			scan_values();
+
+			// Find more block entries (in memory order)
+			std::vector<std::pair<u32, u32>> entries;
+
+			for (auto it = std::lower_bound(ptr_values.begin(), ptr_values.end(), std::make_pair(func.addr, 0u)); it != ptr_values.end() && it->first < func_end2; it++)
 			{
-				for (vm::cptr<u32> ptr = vm::cast(seg.first); ptr.addr() < seg.first + seg.second; ptr++)
-				{
-					const u32 value = *ptr;
+				entries.emplace_back(it->second, it->first);
+			}
 
-					if (value % 4 == 0 && value >= func.addr && value < func_end2)
-					{
-						add_block(value);
-					}
-				}
+			std::sort(entries.begin(), entries.end());
+
+			for (const auto& entry : entries)
+			{
+				add_block(entry.second);
 			}
 		}
 
@@ -1045,93 +1177,105 @@ std::vector<ppu_function> ppu_analyse(const std::vector<std::pair<u32, u32>>& se
 	}
 
 	// Function shrinkage, disabled (TODO: it's potentially dangerous but improvable)
+	std::vector<std::pair<const u32, ppu_function>*> func_list;
+
 	for (auto& _pair : funcs)
 	{
-		auto& func = _pair.second;
+		func_list.emplace_back(&_pair);
+	}
 
-		// Get next function addr
-		const auto _next = funcs.lower_bound(_pair.first + 1);
+	// Every function only modifies itself
+	run_parallel("PPU Analyser", (::size32(func_list) + ppu_func_task_size - 1) / ppu_func_task_size, [&](u32 index)
+	{
+		for (u32 i = index * ppu_func_task_size; i < func_list.size() && i < (index + 1) * ppu_func_task_size; i++)
+		{
+			auto& _pair = *func_list[i];
+			auto& func = _pair.second;
 
-		const u32 next = _next == funcs.end() ? end : _next->first;
+			// Get next function addr
+			const auto _next = funcs.lower_bound(_pair.first + 1);
 
-		// Just ensure that functions don't overlap
-		if (func.addr + func.size > next)
-		{
-			LOG_WARNING(PPU, "Function overlap: [0x%x] 0x%x -> 0x%x", func.addr, func.size, next - func.addr);
-			continue; //func.size = next - func.addr;
+			const u32 next = _next == funcs.end() ? end : _next->first;
 
-			// Also invalidate blocks
-			for (auto& block : func.blocks)
+			// Just ensure that functions don't overlap
+			if (func.addr + func.size > next)
 			{
-				if (block.first + block.second > next)
+				LOG_WARNING(PPU, "Function overlap: [0x%x] 0x%x -> 0x%x", func.addr, func.size, next - func.addr);
+				continue; //func.size = next - func.addr;
+
+				// Also invalidate blocks
+				for (auto& block : func.blocks)
 				{
-					block.second = block.first >= next ? 0 : next - block.first;
+					if (block.first + block.second > next)
+					{
+						block.second = block.first >= next ? 0 : next - block.first;
+					}
 				}
 			}
-		}
 
-		// Suspicious block start
-		u32 start = func.addr + func.size;
+			// Suspicious block start
+			u32 start = func.addr + func.size;
 
-		if (next == end)
-		{
-			continue;
-		}
-
-		// Analyse gaps between functions
-		for (vm::cptr<u32> _ptr = vm::cast(start); _ptr.addr() < next;)
-		{
-			const u32 addr = _ptr.addr();
-			const ppu_opcode_t op{*_ptr++};
-			const ppu_itype::type type = s_ppu_itype.decode(op.opcode);
-
-			if (type == ppu_itype::UNK)
+			if (next == end)
 			{
-				break;
+				continue;
 			}
-			else if (addr == start && op.opcode == ppu_instructions::NOP())
+
+			// Analyse gaps between functions
+			for (vm::cptr<u32> _ptr = vm::cast(start); _ptr.addr() < next;)
 			{
-				if (start == func.addr + func.size)
+				const u32 addr = _ptr.addr();
+				const ppu_opcode_t op{*_ptr++};
+				const ppu_itype::type type = s_ppu_itype.decode(op.opcode);
+
+				if (type == ppu_itype::UNK)
 				{
-					// Extend function with tail NOPs (hack)
-					func.size += 4;
+					break;
 				}
+				else if (addr == start && op.opcode == ppu_instructions::NOP())
+				{
+					if (start == func.addr + func.size)
+					{
+						// Extend function with tail NOPs (hack)
+						func.size += 4;
+					}
 
-				start += 4;
-				continue;
-			}
-			else if (type == ppu_itype::SC && op.opcode != ppu_instructions::SC(0))
-			{
-				break;
-			}
-			else if (addr == start && op.opcode == ppu_instructions::BLR())
-			{
-				start += 4;
-				continue;
-			}
-			else if (type == ppu_itype::B || type == ppu_itype::BC)
-			{
-				const u32 target = (op.aa ? 0 : addr) + (type == ppu_itype::B ? +op.bt24 : +op.bt14);
-
-				if (target == addr)
+					start += 4;
+					continue;
+				}
+				else if (type == ppu_itype::SC && op.opcode != ppu_instructions::SC(0))
 				{
 					break;
 				}
+				else if (addr == start && op.opcode == ppu_instructions::BLR())
+				{
+					start += 4;
+					continue;
+				}
+				else if (type == ppu_itype::B || type == ppu_itype::BC)
+				{
+					const u32 target = (op.aa ? 0 : addr) + (type == ppu_itype::B ? +op.bt24 : +op.bt14);
 
-				_ptr.set(next);
-			}
-			else if (type == ppu_itype::BCLR || type == ppu_itype::BCCTR)
-			{
-				_ptr.set(next);
-			}
+					if (target == addr)
+					{
+						break;
+					}
+
+					_ptr.set(next);
+				}
+				else if (type == ppu_itype::BCLR || type == ppu_itype::BCCTR)
+				{
+					_ptr.set(next);
+				}
 			
-			if (_ptr.addr() >= next)
-			{
-				LOG_WARNING(PPU, "Function gap: [0x%x] 0x%x bytes at 0x%x", func.addr, next - start, start);
-				break;
+				if (_ptr.addr() >= next)
+				{
+					LOG_WARNING(PPU, "Function gap: [0x%x] 0x%x bytes at 0x%x", func.addr, next - start, start);
+					break;
+				}
 			}
 		}
-	}
+	});
 	
 	// Convert map to vector (destructive)
 	std::vector<ppu_function> result;
@@ -738,6 +738,77 @@ static void ppu_load_imports(const std::shared_ptr<ppu_linkage_info>& link, u32
 	}
 }
 
+// Decrypted firmware modules (path -> ELF data)
+struct ppu_prx_cache
+{
+	std::mutex mutex;
+
+	std::unordered_map<std::string, std::shared_ptr<const std::vector<u8>>> map;
+};
+
+// Get decrypted ELF data (moved out of the stream if possible)
+static std::shared_ptr<const std::vector<u8>> ppu_get_elf_data(fs::file elf)
+{
+	if (!elf)
+	{
+		return nullptr;
+	}
+
+	std::unique_ptr<fs::file_base> base = elf.release();
+
+	if (const auto stream = dynamic_cast<fs::container_stream<std::vector<u8>>*>(base.get()))
+	{
+		return std::make_shared<const std::vector<u8>>(std::move(stream->obj));
+	}
+
+	elf.reset(std::move(base));
+	return std::make_shared<const std::vector<u8>>(elf.to_vector<u8>());
+}
+
+// Decrypt SELF/SPRX, firmware modules are only decrypted once per run (returns nullptr on failure)
+extern std::shared_ptr<const std::vector<u8>> ppu_decrypt_prx(const std::string& path)
+{
+	const std::string& flash_dir = vfs::get("/dev_flash/");
+
+	if (flash_dir.empty() || path.compare(0, flash_dir.size(), flash_dir) != 0)
+	{
+		return ppu_get_elf_data(decrypt_self(fs::file(path)));
+	}
+
+	const auto cache = fxm::get_always<ppu_prx_cache>();
+
+	std::shared_ptr<const std::vector<u8>> data;
+	{
+		std::lock_guard<std::mutex> lock(cache->mutex);
+
+		const auto found = cache->map.find(path);
+
+		if (found != cache->map.end())
+		{
+			data = found->second;
+		}
+	}
+
+	if (!data)
+	{
+		data = ppu_get_elf_data(decrypt_self(fs::file(path)));
+
+		if (!data)
+		{
+			return nullptr;
+		}
+
+		std::lock_guard<std::mutex> lock(cache->mutex);
+		data = cache->map.emplace(path, std::move(data)).first->second;
+	}
+	else
+	{
+		LOG_NOTICE(LOADER, "Using decrypted module from cache: %s", path);
+	}
+
+	return data;
+}
+
 std::shared_ptr<lv2_prx> ppu_load_prx(const ppu_prx_object& elf, const std::string& name)
 {
 	std::vector<std::pair<u32, u32>> segments;
@@ -1241,7 +1312,10 @@ void ppu_load_exec(const ppu_exec_object& elf)
 
 		for (const auto& name : load_libs)
 		{
-			const ppu_prx_object obj = decrypt_self(fs::file(lle_dir + name));
+			const auto data = ppu_decrypt_prx(lle_dir + name);
+
+			// Parse the shared data in place
+			const ppu_prx_object obj = data ? fs::file(data->data(), data->size()) : fs::file{};
 
 			if (obj == elf_error::ok)
 			{
@@ -0,0 +1,273 @@
+#include "stdafx.h"
+#include "Utilities/Config.h"
+#include "Crypto/sha1.h"
+#include "PPUObjectCache.h"
+
+#include <cstdlib>
+
+extern cfg::int_entry<0, 1024 * 1024> g_cfg_llvm_cache_size;
+
+// Index file header
+struct ppu_cache_header
+{
+	char magic[4];
+	u32 version;
+	u64 count;
+};
+
+static const char s_cache_magic[4]{'P', 'P', 'U', 'C'};
+
+std::string ppu_object_cache::key_type::to_string() const
+{
+	return fmt::format("%016llx%016llx.obj", hi, lo);
+}
+
+ppu_object_cache::key_type ppu_object_cache::make_key(const u8* hash, const std::string& cpu)
+{
+	sha1_context ctx;
+	u8 output[20];
+	sha1_starts(&ctx);
+
+	const be_t<u32> ver = version;
+	sha1_update(&ctx, reinterpret_cast<const u8*>(&ver), sizeof(ver));
+	sha1_update(&ctx, reinterpret_cast<const u8*>(cpu.data()), cpu.size());
+	sha1_update(&ctx, hash, 20);
+	sha1_finish(&ctx, output);
+
+	key_type key;
+	key.hi = reinterpret_cast<be_t<u64>&>(output[0]);
+	key.lo = reinterpret_cast<be_t<u64>&>(output[8]);
+	return key;
+}
+
+ppu_object_cache::ppu_object_cache()
+	: m_path(fs::get_config_dir() + "data/ppu/")
+	, m_limit(g_cfg_llvm_cache_size * u64{0x100000})
+{
+	if (!fs::is_dir(m_path) && !fs::create_path(m_path))
+	{
+		LOG_ERROR(PPU, "LLVM: Failed to create cache directory: %s", m_path);
+		return;
+	}
+
+	// Read index file
+	bool outdated = false;
+
+	if (fs::file index{m_path + "index.dat"})
+	{
+		ppu_cache_header header;
+		std::vector<entry_type> entries;
+
+		if (!index.read(header) || std::memcmp(header.magic, s_cache_magic, sizeof(s_cache_magic)) != 0 || header.version != version)
+		{
+			LOG_WARNING(PPU, "LLVM: Cache index is outdated or corrupted");
+			outdated = true;
+		}
+		else if (header.count > (index.size() - index.pos()) / sizeof(entry_type))
+		{
+			// Objects are kept but considered the least recently used
+			LOG_WARNING(PPU, "LLVM: Cache index is corrupted (count=%llu)", header.count);
+		}
+		else if (index.read(entries, header.count))
+		{
+			for (const auto& entry : entries)
+			{
+				m_index.emplace(entry.key, entry);
+			}
+		}
+	}
+
+	// Synchronize the index with the actual directory contents
+	std::map<key_type, entry_type> index;
+
+	for (const auto& entry : fs::dir(m_path))
+	{
+		if (entry.is_directory || entry.name.size() != 36 || entry.name.compare(32, 4, ".obj") != 0)
+		{
+			continue;
+		}
+
+		if (outdated)
+		{
+			fs::remove_file(m_path + entry.name);
+			continue;
+		}
+
+		char* end_hi;
+		char* end_lo;
+		key_type key;
+		key.hi = std::strtoull(entry.name.substr(0, 16).c_str(), &end_hi, 16);
+		key.lo = std::strtoull(entry.name.substr(16, 16).c_str(), &end_lo, 16);
+
+		if (*end_hi || *end_lo)
+		{
+			continue;
+		}
+
+		// Unindexed objects are considered the least recently used
+		const auto found = m_index.find(key);
+		const u64 stamp = found != m_index.end() ? found->second.stamp : 0;
+
+		index.emplace(key, entry_type{key, entry.size, stamp});
+		m_total += entry.size;
+		m_stamp = std::max(m_stamp, stamp + 1);
+	}
+
+	m_dirty = outdated || index.size() != m_index.size();
+	m_index = std::move(index);
+
+	LOG_NOTICE(PPU, "LLVM: Object cache: %u objects, %llu KiB (limit: %llu KiB)", m_index.size(), m_total / 1024, m_limit / 1024);
+}
+
+ppu_object_cache::~ppu_object_cache()
+{
+	save();
+}
+
+bool ppu_object_cache::get(const key_type& key, std::string& out)
+{
+	u64 size;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		const auto found = m_index.find(key);
+
+		if (found == m_index.end())
+		{
+			return false;
+		}
+
+		size = found->second.size;
+	}
+
+	// Read the object without blocking other threads (it may be evicted or rewritten meanwhile)
+	const fs::file obj(m_path + key.to_string());
+
+	const bool ok = obj && obj.size() == size && obj.read(out, size);
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	const auto found = m_index.find(key);
+
+	if (!ok)
+	{
+		if (found != m_index.end() && found->second.size == size && !fs::is_file(m_path + key.to_string()))
+		{
+			// Object file was deleted externally
+			m_total -= found->second.size;
+			m_index.erase(found);
+			m_dirty = true;
+		}
+
+		return false;
+	}
+
+	if (found != m_index.end())
+	{
+		found->second.stamp = m_stamp++;
+		m_dirty = true;
+	}
+
+	return true;
+}
+
+void ppu_object_cache::put(const key_type& key, const std::string& obj)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	const std::string path = m_path + key.to_string();
+
+	const fs::file file(path, fs::rewrite);
+
+	if (!file || file.write(obj.data(), obj.size()) != obj.size())
+	{
+		LOG_ERROR(PPU, "LLVM: Failed to write object file: %s", path);
+		fs::remove_file(path);
+		return;
+	}
+
+	auto& entry = m_index[key];
+	m_total -= entry.size;
+	m_total += obj.size();
+	entry = {key, obj.size(), m_stamp++};
+	m_dirty = true;
+
+	evict(key);
+}
+
+void ppu_object_cache::remove(const key_type& key)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	const auto found = m_index.find(key);
+
+	if (found != m_index.end())
+	{
+		fs::remove_file(m_path + key.to_string());
+		m_total -= found->second.size;
+		m_index.erase(found);
+		m_dirty = true;
+	}
+}
+
+void ppu_object_cache::evict(const key_type& keep)
+{
+	while (m_limit && m_total > m_limit && m_index.size() > 1)
+	{
+		// Find the least recently used object (linear search is fine for the expected cache size)
+		auto lru = m_index.end();
+
+		for (auto it = m_index.begin(); it != m_index.end(); it++)
+		{
+			if (!(it->first < keep) && !(keep < it->first))
+			{
+				continue;
+			}
+
+			if (lru == m_index.end() || it->second.stamp < lru->second.stamp)
+			{
+				lru = it;
+			}
+		}
+
+		LOG_NOTICE(PPU, "LLVM: Evicting cached object %s (%llu KiB)", lru->first.to_string(), lru->second.size / 1024);
+
+		fs::remove_file(m_path + lru->first.to_string());
+		m_total -= lru->second.size;
+		m_index.erase(lru);
+	}
+}
+
+void ppu_object_cache::save()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	if (!m_dirty)
+	{
+		return;
+	}
+
+	ppu_cache_header header;
+	std::memcpy(header.magic, s_cache_magic, sizeof(s_cache_magic));
+	header.version = version;
+	header.count = m_index.size();
+
+	std::vector<entry_type> entries;
+	entries.reserve(m_index.size());
+
+	for (const auto& pair : m_index)
+	{
+		entries.emplace_back(pair.second);
+	}
+
+	if (fs::file index{m_path + "index.dat", fs::rewrite})
+	{
+		index.write(header);
+		index.write(entries);
+		m_dirty = false;
+	}
+	else
+	{
+		LOG_ERROR(PPU, "LLVM: Failed to write cache index: %sindex.dat", m_path);
+	}
+}
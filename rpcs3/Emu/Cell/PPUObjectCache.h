@@ -0,0 +1,80 @@
+#pragma once
+
+#include "Utilities/types.h"
+
+#include <map>
+#include <mutex>
+#include <string>
+
+// Persistent content-addressed storage for PPU LLVM object files (shared by all titles)
+class ppu_object_cache final
+{
+public:
+	// Cache format version (increment when the generated code changes)
+	static const u32 version = 1;
+
+	// Truncated SHA-1 of the format version, target CPU and module contents
+	struct key_type
+	{
+		u64 hi;
+		u64 lo;
+
+		bool operator <(const key_type& rhs) const
+		{
+			return hi < rhs.hi || (hi == rhs.hi && lo < rhs.lo);
+		}
+
+		// Object file name
+		std::string to_string() const;
+	};
+
+private:
+	// Index record (also the on-disk format)
+	struct entry_type
+	{
+		key_type key;
+		u64 size;
+		u64 stamp; // Last access time (logical clock)
+	};
+
+	std::mutex m_mutex;
+
+	// Cache directory
+	const std::string m_path;
+
+	// Byte budget (0 = unlimited)
+	const u64 m_limit;
+
+	std::map<key_type, entry_type> m_index;
+
+	// Total size of stored objects
+	u64 m_total = 0;
+
+	// Logical clock for LRU
+	u64 m_stamp = 0;
+
+	// Index needs to be written
+	bool m_dirty = false;
+
+	// Remove least recently used objects until the budget is satisfied
+	void evict(const key_type& keep);
+
+public:
+	ppu_object_cache();
+	~ppu_object_cache();
+
+	// Get cache key for the module hash (20 bytes) and the target CPU
+	static key_type make_key(const u8* hash, const std::string& cpu);
+
+	// Read object file, returns false on cache miss
+	bool get(const key_type& key, std::string& out);
+
+	// Store object file
+	void put(const key_type& key, const std::string& obj);
+
+	// Remove object file (for example, if it's corrupted)
+	void remove(const key_type& key);
+
+	// Write index file
+	void save();
+};
@@ -9,6 +9,7 @@
 #include "PPUInterpreter.h"
 #include "PPUAnalyser.h"
 #include "PPUModule.h"
+#include "PPUObjectCache.h"
 #include "lv2/sys_sync.h"
 #include "lv2/sys_prx.h"
 
@@ -47,6 +48,7 @@
 #endif
 
 #include <cfenv>
+#include <thread>
 #include "Utilities/GSL.h"
 
 extern u64 get_system_time();
@@ -96,6 +98,12 @@ cfg::bool_entry g_cfg_llvm_logs(cfg::root.core, "Save LLVM logs");
 
 cfg::string_entry g_cfg_llvm_cpu(cfg::root.core, "Use LLVM CPU");
 
+// Number of PPU LLVM compiler threads (0 = all host threads)
+cfg::int_entry<0, 64> g_cfg_llvm_threads(cfg::root.core, "Max LLVM Compile Threads", 0);
+
+// Size limit of the PPU object cache in MB (0 = unlimited)
+cfg::int_entry<0, 1024 * 1024> g_cfg_llvm_cache_size(cfg::root.core, "LLVM Cache Size Limit", 4096);
+
 const ppu_decoder<ppu_interpreter_precise> s_ppu_interpreter_precise;
 const ppu_decoder<ppu_interpreter_fast> s_ppu_interpreter_fast;
 
@@ -718,21 +726,24 @@ extern bool ppu_stwcx(ppu_thread& ppu, u32 addr, u32 reg_value)
 {
 	atomic_be_t<u32>& data = vm::_ref<atomic_be_t<u32>>(addr);
 
-	if (ppu.raddr != addr || ppu.rdata != data.load())
+	// Lock only the reservation line (fails if it was updated after lwarx)
+	if (ppu.raddr != addr || ppu.rdata != data.load() || !vm::reservation_trylock(addr, ppu.rtime))
 	{
 		ppu.raddr = 0;
 		return false;
 	}
 
-	vm::writer_lock lock(0);
-
-	const bool result = ppu.rtime == vm::reservation_acquire(addr, sizeof(u32)) && data.compare_and_swap_test(static_cast<u32>(ppu.rdata), reg_value);
+	const bool result = data.compare_and_swap_test(static_cast<u32>(ppu.rdata), reg_value);
 	
 	if (result)
 	{
 		vm::reservation_update(addr, sizeof(u32));
 		vm::notify(addr, sizeof(u32));
 	}
+	else
+	{
+		vm::reservation_unlock(addr, ppu.rtime);
+	}
 
 	ppu.raddr = 0;
 	return result;
@@ -742,21 +753,24 @@ extern bool ppu_stdcx(ppu_thread& ppu, u32 addr, u64 reg_value)
 {
 	atomic_be_t<u64>& data = vm::_ref<atomic_be_t<u64>>(addr);
 
-	if (ppu.raddr != addr || ppu.rdata != data.load())
+	// Lock only the reservation line (fails if it was updated after ldarx)
+	if (ppu.raddr != addr || ppu.rdata != data.load() || !vm::reservation_trylock(addr, ppu.rtime))
 	{
 		ppu.raddr = 0;
 		return false;
 	}
 
-	vm::writer_lock lock(0);
-
-	const bool result = ppu.rtime == vm::reservation_acquire(addr, sizeof(u64)) && data.compare_and_swap_test(ppu.rdata, reg_value);
+	const bool result = data.compare_and_swap_test(ppu.rdata, reg_value);
 
 	if (result)
 	{
 		vm::reservation_update(addr, sizeof(u64));
 		vm::notify(addr, sizeof(u64));
 	}
+	else
+	{
+		vm::reservation_unlock(addr, ppu.rtime);
+	}
 
 	ppu.raddr = 0;
 	return result;
@@ -773,6 +787,8 @@ static bool adde_carry(u64 a, u64 b, bool c)
 #endif
 }
 
+static void ppu_initialize(const std::vector<const ppu_module*>& modules);
+
 extern void ppu_initialize()
 {
 	const auto _funcs = fxm::withdraw<std::vector<ppu_function>>();
@@ -801,12 +817,14 @@ extern void ppu_initialize()
 		return;
 	}
 
+	std::vector<ppu_module> parts;
 	std::size_t fpos = 0;
 
 	while (fpos < _funcs->size())
 	{
 		// Split module (TODO)
-		ppu_module info;
+		parts.emplace_back();
+		ppu_module& info = parts.back();
 		info.name = fmt::format("%05X", _funcs->at(fpos).addr);
 		info.funcs.reserve(2000);
 		
@@ -814,20 +832,30 @@ extern void ppu_initialize()
 		{
 			info.funcs.emplace_back(std::move(_funcs->at(fpos++)));
 		}
+	}
 
-		if (!Emu.IsStopped())
-		{
-			ppu_initialize(info);
-		}
+	// Keep PRX objects alive during compilation
+	std::vector<std::shared_ptr<lv2_prx>> prx_list;
+
+	idm::select<lv2_obj, lv2_prx>([&](u32 id, lv2_prx&)
+	{
+		prx_list.emplace_back(idm::get_unlocked<lv2_obj, lv2_prx>(id));
+	});
+
+	std::vector<const ppu_module*> modules;
+	modules.reserve(parts.size() + prx_list.size());
+
+	for (const auto& part : parts)
+	{
+		modules.emplace_back(&part);
 	}
 
-	idm::select<lv2_obj, lv2_prx>([](u32, lv2_prx& prx)
+	for (const auto& prx : prx_list)
 	{
-		if (!Emu.IsStopped())
-		{
-			ppu_initialize(prx);
-		}
-	});	
+		modules.emplace_back(prx.get());
+	}
+
+	ppu_initialize(modules);
 }
 
 extern void ppu_initialize(const ppu_module& info)
@@ -842,8 +870,180 @@ extern void ppu_initialize(const ppu_module& info)
 		return;
 	}
 
+	ppu_initialize(std::vector<const ppu_module*>{&info});
+}
+
+#ifdef LLVM_AVAILABLE
+// Progress dialog shared by all PPU compiler threads
+class ppu_progress_dialog final
+{
+	std::mutex m_mutex;
+
+	std::shared_ptr<MsgDialogBase> m_dlg;
+
+	const u32 m_total;
+	const u32 m_threads;
+
+	// Functions processed
+	u32 m_done = 0;
+
+	// Progress bar position (percents)
+	u32 m_shown = 0;
+
+public:
+	ppu_progress_dialog(u32 total, u32 threads)
+		: m_total(total)
+		, m_threads(threads)
+	{
+	}
+
+	// Report processed functions; the dialog is only opened when actual compilation takes place
+	void update(u32 count, bool compiling)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		m_done += count;
+
+		if (!m_dlg)
+		{
+			if (!compiling)
+			{
+				return;
+			}
+
+			m_dlg = Emu.GetCallbacks().get_msg_dialog();
+			m_dlg->type.se_normal = true;
+			m_dlg->type.bg_invisible = true;
+			m_dlg->type.progress_bar_count = 1;
+			m_dlg->on_close = [](s32 status)
+			{
+				Emu.CallAfter([]()
+				{
+					// Abort everything
+					Emu.Stop();
+				});
+			};
+
+			Emu.CallAfter([dlg = m_dlg, threads = m_threads]()
+			{
+				dlg->Create(fmt::format("Compiling PPU executable (%u thread%s)\nPlease wait...", threads, threads == 1 ? "" : "s"));
+			});
+		}
+
+		const u32 pos = m_total ? ::narrow<u32>(u64{m_done} * 100 / m_total) : 100;
+
+		Emu.CallAfter([dlg = m_dlg, msg = fmt::format("Compiling %u of %u", m_done, m_total), delta = pos - std::exchange(m_shown, pos)]()
+		{
+			dlg->ProgressBarSetMsg(0, msg);
+
+			if (delta)
+				dlg->ProgressBarInc(0, delta);
+		});
+	}
+};
+
+// Serializes access to the execution engine
+static std::mutex s_jit_mutex;
+
+static std::shared_ptr<jit_compiler> ppu_initialize_jit()
+{
+	if (const auto jit = fxm::get<jit_compiler>())
+	{
+		return jit;
+	}
+
+	std::unordered_map<std::string, std::uintptr_t> link_table
+	{
+		{ "__mptr", (u64)&vm::g_base_addr },
+		{ "__cptr", (u64)&s_ppu_compiled },
+		{ "__trap", (u64)&ppu_trap },
+		{ "__end", (u64)&ppu_unreachable },
+		{ "__check", (u64)&ppu_check },
+		{ "__trace", (u64)&ppu_trace },
+		{ "__hlecall", (u64)&ppu_execute_function },
+		{ "__syscall", (u64)&ppu_execute_syscall },
+		{ "__get_tb", (u64)&get_timebased_time },
+		{ "__lwarx", (u64)&ppu_lwarx },
+		{ "__ldarx", (u64)&ppu_ldarx },
+		{ "__stwcx", (u64)&ppu_stwcx },
+		{ "__stdcx", (u64)&ppu_stdcx },
+		{ "__adde_get_ca", (u64)&adde_carry },
+		{ "__vexptefp", (u64)&sse_exp2_ps },
+		{ "__vlogefp", (u64)&sse_log2_ps },
+		{ "__vperm", (u64)&sse_altivec_vperm },
+		{ "__lvsl", (u64)&sse_altivec_lvsl },
+		{ "__lvsr", (u64)&sse_altivec_lvsr },
+		{ "__lvlx", (u64)&sse_cellbe_lvlx },
+		{ "__lvrx", (u64)&sse_cellbe_lvrx },
+		{ "__stvlx", (u64)&sse_cellbe_stvlx },
+		{ "__stvrx", (u64)&sse_cellbe_stvrx },
+	};
+
+	for (u64 index = 0; index < 1024; index++)
+	{
+		if (auto sc = ppu_get_syscall(index))
+		{
+			link_table.emplace(ppu_get_syscall_name(index), (u64)sc);
+		}
+	}
+
+	for (u64 index = 1; ; index++)
+	{
+		if (auto func = ppu_get_function(index))
+		{
+			link_table.emplace(ppu_get_module_function_name(index), (u64)func);
+		}
+		else
+		{
+			break;
+		}
+	}
+
+	const auto jit = fxm::make<jit_compiler>(std::move(link_table), g_cfg_llvm_cpu.get());
+
+	LOG_SUCCESS(PPU, "LLVM: JIT initialized (%s)", jit->cpu());
+	return jit;
+}
+
+// Load object code into the execution engine and install function addresses
+static bool ppu_install(jit_compiler& jit, const ppu_module& info, const std::string& obj)
+{
+	std::vector<std::string> names;
+
+	for (const auto& func : info.funcs)
+	{
+		if (func.size)
+		{
+			names.emplace_back(fmt::format("__0x%x", func.addr));
+		}
+	}
+
+	std::lock_guard<std::mutex> lock(s_jit_mutex);
+
+	if (!jit.load(obj, names))
+	{
+		return false;
+	}
+
+	for (const auto& func : info.funcs)
+	{
+		if (func.size)
+		{
+			const std::uintptr_t link = jit.get(fmt::format("__0x%x", func.addr));
+			s_ppu_compiled[func.addr / 4] = ::narrow<u32>(link);
+		}
+	}
+
+	return true;
+}
+
+// Translate, optimize and emit single module (called from compiler threads)
+static void ppu_initialize2(jit_compiler& jit, ppu_object_cache& cache, const ppu_module& info, ppu_progress_dialog& progress)
+{
+	using namespace llvm;
+
 	// Compute module hash
-	std::string obj_name;
+	ppu_object_cache::key_type key;
 	{
 		sha1_context ctx;
 		u8 output[20];
@@ -874,81 +1074,44 @@ extern void ppu_initialize(const ppu_module& info)
 		
 		sha1_finish(&ctx, output);
 
-		// Version, module name and hash: vX-liblv2.sprx-0123456789ABCDEF.obj
-		fmt::append(obj_name, "v0-%s-%016X.obj", info.name, reinterpret_cast<be_t<u64>&>(output));
+		// Mix in cache version and target CPU
+		key = ppu_object_cache::make_key(output, jit.cpu());
 	}
 
-#ifdef LLVM_AVAILABLE
-	using namespace llvm;
+	// Module name and cache key: liblv2.sprx-0123456789ABCDEF0123456789ABCDEF.obj
+	const std::string obj_name = info.name + '-' + key.to_string();
 
-	if (!fxm::check<jit_compiler>())
-	{
-		std::unordered_map<std::string, std::uintptr_t> link_table
-		{
-			{ "__mptr", (u64)&vm::g_base_addr },
-			{ "__cptr", (u64)&s_ppu_compiled },
-			{ "__trap", (u64)&ppu_trap },
-			{ "__end", (u64)&ppu_unreachable },
-			{ "__check", (u64)&ppu_check },
-			{ "__trace", (u64)&ppu_trace },
-			{ "__hlecall", (u64)&ppu_execute_function },
-			{ "__syscall", (u64)&ppu_execute_syscall },
-			{ "__get_tb", (u64)&get_timebased_time },
-			{ "__lwarx", (u64)&ppu_lwarx },
-			{ "__ldarx", (u64)&ppu_ldarx },
-			{ "__stwcx", (u64)&ppu_stwcx },
-			{ "__stdcx", (u64)&ppu_stdcx },
-			{ "__adde_get_ca", (u64)&adde_carry },
-			{ "__vexptefp", (u64)&sse_exp2_ps },
-			{ "__vlogefp", (u64)&sse_log2_ps },
-			{ "__vperm", (u64)&sse_altivec_vperm },
-			{ "__lvsl", (u64)&sse_altivec_lvsl },
-			{ "__lvsr", (u64)&sse_altivec_lvsr },
-			{ "__lvlx", (u64)&sse_cellbe_lvlx },
-			{ "__lvrx", (u64)&sse_cellbe_lvrx },
-			{ "__stvlx", (u64)&sse_cellbe_stvlx },
-			{ "__stvrx", (u64)&sse_cellbe_stvrx },
-		};
-
-		for (u64 index = 0; index < 1024; index++)
-		{
-			if (auto sc = ppu_get_syscall(index))
-			{
-				link_table.emplace(ppu_get_syscall_name(index), (u64)sc);
-			}
-		}
+	const u32 fmax = ::size32(info.funcs);
+
+	std::string cached;
 
-		for (u64 index = 1; ; index++)
+	if (cache.get(key, cached))
+	{
+		if (ppu_install(jit, info, cached))
 		{
-			if (auto func = ppu_get_function(index))
-			{
-				link_table.emplace(ppu_get_module_function_name(index), (u64)func);
-			}
-			else
-			{
-				break;
-			}
+			progress.update(fmax, false);
+			LOG_SUCCESS(PPU, "LLVM: Loaded executable: %s", obj_name);
+			return;
 		}
-
-		const auto jit = fxm::make<jit_compiler>(std::move(link_table), g_cfg_llvm_cpu.get());
-
-		LOG_SUCCESS(PPU, "LLVM: JIT initialized (%s)", jit->cpu());
+		
+		LOG_ERROR(PPU, "LLVM: Failed to load executable: %s", obj_name);
+		cache.remove(key);
 	}
 
-	// Initialize compiler
-	const auto jit = fxm::get<jit_compiler>();
+	// Context is private for each compiler thread
+	LLVMContext context;
 
 	// Create LLVM module
-	std::unique_ptr<Module> module = std::make_unique<Module>(obj_name, g_llvm_ctx);
+	std::unique_ptr<Module> module = std::make_unique<Module>(obj_name, context);
 
 	// Initialize target
 	module->setTargetTriple(Triple::normalize(sys::getProcessTriple()));
 	
 	// Initialize translator
-	std::unique_ptr<PPUTranslator> translator = std::make_unique<PPUTranslator>(g_llvm_ctx, module.get(), 0);
+	std::unique_ptr<PPUTranslator> translator = std::make_unique<PPUTranslator>(context, module.get(), 0);
 
 	// Define some types
-	const auto _void = Type::getVoidTy(g_llvm_ctx);
+	const auto _void = Type::getVoidTy(context);
 	const auto _func = FunctionType::get(_void, { translator->GetContextType()->getPointerTo() }, false);
 
 	// Initialize function list
@@ -962,34 +1125,6 @@ extern void ppu_initialize(const ppu_module& info)
 		}
 	}
 
-	if (fs::file cached{Emu.GetCachePath() + obj_name})
-	{
-		std::string buf;
-		buf.reserve(cached.size());
-		cached.read(buf, cached.size());
-		auto buffer = llvm::MemoryBuffer::getMemBuffer(buf, obj_name);
-		auto result = llvm::object::ObjectFile::createObjectFile(*buffer);
-		
-		if (result)
-		{
-			jit->load(std::move(module), std::move(result.get()));
-
-			for (const auto& func : info.funcs)
-			{
-				if (func.size)
-				{
-					const std::uintptr_t link = jit->get(fmt::format("__0x%x", func.addr));
-					s_ppu_compiled[func.addr / 4] = ::narrow<u32>(link);
-				}
-			}
-
-			LOG_SUCCESS(PPU, "LLVM: Loaded executable: %s", obj_name);
-			return;
-		}
-		
-		LOG_ERROR(PPU, "LLVM: Failed to load executable: %s", obj_name);
-	}
-
 	legacy::FunctionPassManager pm(module.get());
 	
 	// Basic optimizations
@@ -1012,27 +1147,8 @@ extern void ppu_initialize(const ppu_module& info)
 	pm.add(createCFGSimplificationPass());
 	//pm.add(createLintPass()); // Check
 
-	// Initialize message dialog
-	const auto dlg = Emu.GetCallbacks().get_msg_dialog();
-	dlg->type.se_normal = true;
-	dlg->type.bg_invisible = true;
-	dlg->type.progress_bar_count = 1;
-	dlg->on_close = [](s32 status)
-	{
-		Emu.CallAfter([]()
-		{
-			// Abort everything
-			Emu.Stop();
-		});
-	};
-
-	Emu.CallAfter([=]()
-	{
-		dlg->Create("Compiling PPU executable: " + info.name + "\nPlease wait...");
-	});
-
 	// Translate functions
-	for (size_t fi = 0, fmax = info.funcs.size(); fi < fmax; fi++)
+	for (size_t fi = 0; fi < fmax; fi++)
 	{
 		if (Emu.IsStopped())
 		{
@@ -1040,17 +1156,11 @@ extern void ppu_initialize(const ppu_module& info)
 			return;
 		}
 
+		// Update dialog
+		progress.update(1, true);
+
 		if (info.funcs[fi].size)
 		{
-			// Update dialog		
-			Emu.CallAfter([=, max = info.funcs.size()]()
-			{
-				dlg->ProgressBarSetMsg(0, fmt::format("Compiling %u of %u", fi + 1, fmax));
-
-				if (fi * 100 / fmax != (fi + 1) * 100 / fmax)
-					dlg->ProgressBarInc(0, 1);
-			});
-
 			// Translate
 			const auto func = translator->TranslateToIR(info.funcs[fi], vm::_ptr<u32>(info.funcs[fi].addr));
 
@@ -1136,13 +1246,6 @@ extern void ppu_initialize(const ppu_module& info)
 	mpm.add(createDeadInstEliminationPass());
 	mpm.run(*module);
 
-	// Update dialog
-	Emu.CallAfter([=]()
-	{
-		dlg->ProgressBarSetMsg(0, "Generating code...");
-		dlg->ProgressBarInc(0, 100);
-	});
-
 	std::string result;
 	raw_string_ostream out(result);
 
@@ -1162,18 +1265,92 @@ extern void ppu_initialize(const ppu_module& info)
 
 	LOG_NOTICE(PPU, "LLVM: %zu functions generated", module->getFunctionList().size());
 
-	jit->make(std::move(module), Emu.GetCachePath() + obj_name);
+	// Generate machine code (the most expensive part, done without locking)
+	const std::string obj = jit.compile(*module);
 
-	// Get and install function addresses
-	for (const auto& func : info.funcs)
+	cache.put(key, obj);
+
+	if (!ppu_install(jit, info, obj))
 	{
-		if (func.size)
+		fmt::throw_exception("LLVM: Failed to load generated executable: %s" HERE, obj_name);
+	}
+
+	LOG_SUCCESS(PPU, "LLVM: Created executable: %s", obj_name);
+}
+#endif
+
+static void ppu_initialize(const std::vector<const ppu_module*>& modules)
+{
+#ifdef LLVM_AVAILABLE
+	const auto jit = ppu_initialize_jit();
+	const auto cache = fxm::get_always<ppu_object_cache>();
+
+	u32 fmax = 0;
+
+	for (const auto info : modules)
+	{
+		fmax += ::size32(info->funcs);
+	}
+
+	// Select the number of compiler threads
+	const u32 max_threads = g_cfg_llvm_threads ? g_cfg_llvm_threads : std::max<u32>(std::thread::hardware_concurrency(), 1);
+	const u32 thread_count = std::max<u32>(std::min<u32>(max_threads, ::size32(modules)), 1);
+
+	ppu_progress_dialog progress(fmax, thread_count);
+
+	// Next module to process
+	atomic_t<u32> index{0};
+
+	auto worker = [&]()
+	{
+		for (u32 i; (i = index++) < modules.size();)
 		{
-			const std::uintptr_t link = jit->get(fmt::format("__0x%x", func.addr));
-			s_ppu_compiled[func.addr / 4] = ::narrow<u32>(link);
+			if (Emu.IsStopped())
+			{
+				break;
+			}
+
+			ppu_initialize2(*jit, *cache, *modules[i], progress);
 		}
+	};
+
+	if (thread_count == 1)
+	{
+		worker();
+		cache->save();
+		return;
 	}
 
-	LOG_SUCCESS(PPU, "LLVM: Created executable: %s", obj_name);
+	std::vector<std::shared_ptr<thread_ctrl>> threads(thread_count);
+
+	for (u32 i = 0; i < thread_count; i++)
+	{
+		thread_ctrl::spawn(threads[i], fmt::format("PPU Compiler %u", i), worker);
+	}
+
+	// Join all threads before rethrowing the first exception
+	std::exception_ptr error;
+
+	for (const auto& thread : threads)
+	{
+		try
+		{
+			thread->join();
+		}
+		catch (...)
+		{
+			if (!error)
+			{
+				error = std::current_exception();
+			}
+		}
+	}
+
+	if (error)
+	{
+		std::rethrow_exception(error);
+	}
+
+	cache->save();
 #endif
 }
@@ -1,6 +1,7 @@
 #include "stdafx.h"
 #include "Emu/Memory/Memory.h"
 #include "Emu/System.h"
+#include "Emu/IdManager.h"
 
 #include "SPUDisAsm.h"
 #include "SPUThread.h"
@@ -23,8 +24,8 @@
 const spu_decoder<spu_interpreter_fast> s_spu_interpreter; // TODO: remove
 const spu_decoder<spu_recompiler> s_spu_decoder;
 
-spu_recompiler::spu_recompiler()
-	: m_jit(std::make_shared<asmjit::JitRuntime>())
+spu_runtime::spu_runtime()
+	: jit(std::make_shared<asmjit::JitRuntime>())
 {
 	asmjit::X86CpuInfo inf;
 	asmjit::X86CpuUtil::detect(&inf);
@@ -34,6 +35,11 @@ spu_recompiler::spu_recompiler()
 	fs::file(fs::get_config_dir() + "SPUJIT.log", fs::rewrite).write(fmt::format("SPU JIT initialization...\n\nTitle: %s\nTitle ID: %s\n\n", Emu.GetTitle().c_str(), Emu.GetTitleID().c_str()));
 }
 
+spu_recompiler::spu_recompiler()
+	: m_jit(fxm::get_always<spu_runtime>()->jit)
+{
+}
+
 void spu_recompiler::compile(spu_function_t& f)
 {
 	std::lock_guard<std::mutex> lock(m_mutex);
@@ -208,8 +214,15 @@ void spu_recompiler::compile(spu_function_t& f)
 	// Finalization
 	compiler.endFunc();
 
-	// Compile and store function address
-	f.compiled = asmjit_cast<decltype(f.compiled)>(compiler.make());
+	// Compile and publish function address
+	const auto code = compiler.make();
+
+	if (!f.compiled.compare_and_swap_test(nullptr, asmjit_cast<spu_function_t::func_t>(code)))
+	{
+		// Compiled concurrently by another thread
+		m_jit->release(code);
+		return;
+	}
 
 	// Add ASMJIT logs
 	log += logger.getString();
@@ -12,7 +12,16 @@ namespace asmjit
 	struct Label;
 }
 
-// SPU ASMJIT Recompiler
+// SPU ASMJIT Runtime (executable memory shared by all recompiler instances)
+class spu_runtime
+{
+public:
+	const std::shared_ptr<asmjit::JitRuntime> jit;
+
+	spu_runtime();
+};
+
+// SPU ASMJIT Recompiler (one instance per thread, compiled functions are shared)
 class spu_recompiler : public spu_recompiler_base
 {
 	const std::shared_ptr<asmjit::JitRuntime> m_jit;
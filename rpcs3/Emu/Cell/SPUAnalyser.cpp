@@ -1,7 +1,12 @@
 #include "stdafx.h"
+#include "Utilities/Thread.h"
+#include "Crypto/sha1.h"
+#include "Emu/System.h"
+#include "Emu/IdManager.h"
 #include "SPUAnalyser.h"
 #include "SPURecompiler.h"
 #include "SPUOpcodes.h"
+#include "SPUASMJITRecompiler.h"
 
 const spu_decoder<spu_itype> s_spu_itype;
 
@@ -21,16 +26,222 @@ std::shared_ptr<spu_function_t> SPUDatabase::find(const be_t<u32>* data, u64 key
 	return nullptr;
 }
 
+// Get database key: SHA-1 of the function address and contents
+static std::array<u8, 20> get_hash(const spu_function_t& func)
+{
+	const le_t<u32> addr = func.addr;
+
+	sha1_context ctx;
+	sha1_starts(&ctx);
+	sha1_update(&ctx, reinterpret_cast<const u8*>(&addr), sizeof(addr));
+	sha1_update(&ctx, reinterpret_cast<const u8*>(func.data.data()), func.size);
+
+	std::array<u8, 20> result;
+	sha1_finish(&ctx, result.data());
+	return result;
+}
+
+// Database file header
+struct spu_db_header
+{
+	char magic[4];
+	u32 version;
+	u32 count;
+};
+
+// Function record header (followed by the function contents and the block, adjacent and jump table sets)
+struct spu_db_record
+{
+	u8 hash[20];
+	u32 addr;
+	u32 size;
+	u32 blocks;
+	u32 adjacent;
+	u32 jtable;
+	u32 does_reset_stack;
+};
+
+static const char s_db_magic[4]{'S', 'P', 'U', 'D'};
+
 SPUDatabase::SPUDatabase()
 {
-	// TODO: load existing database associated with currently running executable
+	if (!Emu.GetCachePath().empty())
+	{
+		m_path = Emu.GetCachePath() + "spu.db";
+		load();
+	}
 
-	LOG_SUCCESS(SPU, "SPU Database initialized...");
+	LOG_SUCCESS(SPU, "SPU Database initialized (%u functions loaded)...", m_loaded.size());
 }
 
 SPUDatabase::~SPUDatabase()
 {
-	// TODO: serialize database
+	on_stop();
+}
+
+void SPUDatabase::on_init(const std::shared_ptr<void>&)
+{
+	if (m_loaded.empty())
+	{
+		return;
+	}
+
+	// Own instance, created here because fxm is locked in the constructor
+	const auto rec = std::make_shared<spu_recompiler>();
+
+	thread_ctrl::spawn(m_thread, "SPU Precompiler", [this, rec]()
+	{
+		std::size_t count = 0;
+
+		for (const auto& func : m_loaded)
+		{
+			if (m_stop || Emu.IsStopped())
+			{
+				break;
+			}
+
+			rec->compile(*func);
+			count++;
+		}
+
+		LOG_NOTICE(SPU, "Precompiled %u/%u SPU functions", count, m_loaded.size());
+	});
+}
+
+void SPUDatabase::on_stop()
+{
+	if (m_thread)
+	{
+		m_stop = true;
+		m_thread->join();
+		m_thread.reset();
+	}
+
+	save();
+}
+
+void SPUDatabase::load()
+{
+	const fs::file db(m_path);
+
+	if (!db)
+	{
+		return;
+	}
+
+	spu_db_header header;
+
+	if (!db.read(header) || std::memcmp(header.magic, s_db_magic, sizeof(s_db_magic)) != 0 || header.version != version)
+	{
+		LOG_WARNING(SPU, "SPU Database is outdated or corrupted: %s", m_path);
+		return;
+	}
+
+	const auto read_set = [&](std::set<u32>& set, u32 count)
+	{
+		std::vector<u32> values;
+
+		// There can't be more entries than instructions in LS
+		if (count > 0x40000 / 4 || count * sizeof(u32) > db.size() - db.pos() || !db.read(values, count))
+		{
+			return false;
+		}
+
+		set.insert(values.begin(), values.end());
+		return true;
+	};
+
+	for (u32 i = 0; i < header.count; i++)
+	{
+		spu_db_record rec;
+
+		if (!db.read(rec) || rec.addr >= 0x40000 || rec.addr % 4 || !rec.size || rec.size > 0x40000 - rec.addr || rec.size % 4)
+		{
+			LOG_ERROR(SPU, "SPU Database is corrupted (record %u)", i);
+			break;
+		}
+
+		auto func = std::make_shared<spu_function_t>(rec.addr, rec.size);
+		func->data.resize(rec.size / 4);
+		func->does_reset_stack = rec.does_reset_stack != 0;
+
+		if (db.read(func->data.data(), rec.size) != rec.size ||
+			!read_set(func->blocks, rec.blocks) ||
+			!read_set(func->adjacent, rec.adjacent) ||
+			!read_set(func->jtable, rec.jtable))
+		{
+			LOG_ERROR(SPU, "SPU Database is corrupted (function 0x%05x)", rec.addr);
+			break;
+		}
+
+		const auto hash = get_hash(*func);
+
+		if (std::memcmp(hash.data(), rec.hash, sizeof(rec.hash)) != 0)
+		{
+			LOG_ERROR(SPU, "SPU Database is corrupted (function 0x%05x)", rec.addr);
+			break;
+		}
+
+		// Skip duplicates
+		if (m_hashes.emplace(hash, func).second)
+		{
+			m_db.emplace(func->addr | u64{func->data[0]} << 32, func);
+			m_loaded.emplace_back(std::move(func));
+		}
+	}
+}
+
+void SPUDatabase::save()
+{
+	writer_lock lock(m_mutex);
+
+	if (!m_dirty || m_path.empty())
+	{
+		return;
+	}
+
+	fs::file db(m_path, fs::rewrite);
+
+	if (!db)
+	{
+		LOG_ERROR(SPU, "Failed to write SPU Database: %s", m_path);
+		return;
+	}
+
+	spu_db_header header;
+	std::memcpy(header.magic, s_db_magic, sizeof(s_db_magic));
+	header.version = version;
+	header.count = ::size32(m_hashes);
+	db.write(header);
+
+	const auto write_set = [&](const std::set<u32>& set)
+	{
+		db.write(std::vector<u32>(set.begin(), set.end()));
+	};
+
+	for (const auto& pair : m_hashes)
+	{
+		const auto& func = *pair.second;
+
+		spu_db_record rec;
+		std::memcpy(rec.hash, pair.first.data(), sizeof(rec.hash));
+		rec.addr = func.addr;
+		rec.size = func.size;
+		rec.blocks = ::size32(func.blocks);
+		rec.adjacent = ::size32(func.adjacent);
+		rec.jtable = ::size32(func.jtable);
+		rec.does_reset_stack = func.does_reset_stack;
+
+		db.write(rec);
+		db.write(func.data.data(), func.size);
+		write_set(func.blocks);
+		write_set(func.adjacent);
+		write_set(func.jtable);
+	}
+
+	m_dirty = false;
+
+	LOG_NOTICE(SPU, "SPU Database saved (%u functions)", m_hashes.size());
 }
 
 std::shared_ptr<spu_function_t> SPUDatabase::analyse(const be_t<u32>* ls, u32 entry, u32 max_limit)
@@ -313,6 +524,8 @@ std::shared_ptr<spu_function_t> SPUDatabase::analyse(const be_t<u32>* ls, u32 en
 
 	// Add function to the database
 	m_db.emplace(key, func);
+	m_hashes.emplace(get_hash(*func), func);
+	m_dirty = true;
 
 	LOG_SUCCESS(SPU, "Function detected [0x%05x-0x%05x] (size=0x%x)", func->addr, func->addr + func->size, func->size);
 
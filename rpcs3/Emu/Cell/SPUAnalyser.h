@@ -3,6 +3,7 @@
 #include "Utilities/mutex.h"
 
 #include <set>
+#include <map>
 
 // SPU Instruction Type
 struct spu_itype
@@ -270,8 +271,13 @@ struct spu_function_t
 	// Whether ila $SP,* instruction found
 	bool does_reset_stack;
 
-	// Pointer to the compiled function
-	u32(*compiled)(SPUThread* _spu, be_t<u32>* _ls) = nullptr;
+	using func_t = u32(*)(SPUThread* _spu, be_t<u32>* _ls);
+
+	// Pointer to the compiled function (published atomically, can be compiled by several threads)
+	atomic_t<func_t> compiled{nullptr};
+
+	// Whether the function was queued for asynchronous compilation
+	atomic_t<bool> queued{false};
 
 	spu_function_t(u32 addr, u32 size)
 		: addr(addr)
@@ -280,6 +286,8 @@ struct spu_function_t
 	}
 };
 
+class thread_ctrl;
+
 // SPU Function Database (must be global or PS3 process-local)
 class SPUDatabase final : spu_itype
 {
@@ -288,13 +296,45 @@ class SPUDatabase final : spu_itype
 	// All registered functions (uses addr and first instruction as a key)
 	std::unordered_multimap<u64, std::shared_ptr<spu_function_t>> m_db;
 
+	// All registered functions keyed by SHA-1 of their address and contents (persistent key)
+	std::map<std::array<u8, 20>, std::shared_ptr<spu_function_t>> m_hashes;
+
+	// Database file (per title)
+	std::string m_path;
+
+	// Functions loaded from the file (to be precompiled)
+	std::vector<std::shared_ptr<spu_function_t>> m_loaded;
+
+	// Background precompilation thread
+	std::shared_ptr<thread_ctrl> m_thread;
+
+	atomic_t<bool> m_stop{false};
+
+	// New functions were added since loading
+	bool m_dirty = false;
+
 	// For internal use
 	std::shared_ptr<spu_function_t> find(const be_t<u32>* data, u64 key, u32 max_size);
 
+	// Read database file
+	void load();
+
+	// Write database file
+	void save();
+
 public:
+	// Database file format version (increment when the analyser changes)
+	static const u32 version = 2;
+
 	SPUDatabase();
 	~SPUDatabase();
 
+	// Start precompiling loaded functions
+	void on_init(const std::shared_ptr<void>&);
+
+	// Stop precompilation and save the database
+	void on_stop();
+
 	// Try to retrieve SPU function information
 	std::shared_ptr<spu_function_t> analyse(const be_t<u32>* ls, u32 entry, u32 limit = 0x40000);
 };
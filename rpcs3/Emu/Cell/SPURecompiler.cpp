@@ -1,13 +1,124 @@
 #include "stdafx.h"
+#include "Utilities/Config.h"
 #include "Emu/IdManager.h"
 #include "Emu/Memory/Memory.h"
+#include "Emu/System.h"
 
 #include "SPUThread.h"
+#include "SPUInterpreter.h"
 #include "SPURecompiler.h"
 #include "SPUASMJITRecompiler.h"
 
+#include <deque>
+
 extern u64 get_system_time();
 
+// Interpret new functions while they are compiled in the background
+cfg::bool_entry g_cfg_spu_async_compile(cfg::root.core, "SPU Asynchronous Compilation");
+
+const spu_decoder<spu_interpreter_fast> s_spu_itp;
+static const spu_decoder<spu_itype> s_spu_itype;
+
+// Background SPU compiler thread (asynchronous mode)
+class spu_async_compiler final : public named_thread
+{
+	std::mutex m_mutex;
+
+	std::deque<std::shared_ptr<spu_function_t>> m_queue;
+
+	std::string get_name() const override { return "SPU Compiler Thread"; }
+
+	void on_task() override
+	{
+		const auto rec = std::make_shared<spu_recompiler>();
+
+		while (!Emu.IsStopped())
+		{
+			std::shared_ptr<spu_function_t> func;
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+
+				if (!m_queue.empty())
+				{
+					func = std::move(m_queue.front());
+					m_queue.pop_front();
+				}
+			}
+
+			if (!func)
+			{
+				thread_ctrl::wait_for(10000);
+				continue;
+			}
+
+			rec->compile(*func);
+		}
+	}
+
+public:
+	void push(const std::shared_ptr<spu_function_t>& func)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_queue.emplace_back(func);
+		}
+
+		notify();
+	}
+};
+
+// Interpret the function until control leaves it (calls are processed recursively like in compiled code)
+static void spu_interpret(SPUThread& spu, const be_t<u32>* _ls, const spu_function_t& func)
+{
+	while (true)
+	{
+		const u32 pc = spu.pc;
+		const u32 op = _ls[pc / 4];
+
+		s_spu_itp.decode(op)(spu, {op});
+
+		spu.pc += 4;
+
+		if (spu.pc != pc + 4)
+		{
+			const auto type = s_spu_itype.decode(op);
+
+			if (type == spu_itype::BRSL || type == spu_itype::BRASL || type == spu_itype::BISL || type == spu_itype::BISLED)
+			{
+				const u32 link = (pc + 4) & 0x3fffc;
+
+				spu.recursion_level++;
+
+				while (!test(spu.state) || !spu.check_state())
+				{
+					spu_recompiler_base::enter(spu);
+
+					if (test(spu.state & cpu_flag::ret) || spu.pc == link)
+					{
+						break;
+					}
+				}
+
+				spu.recursion_level--;
+
+				if (spu.pc != link)
+				{
+					return;
+				}
+			}
+			else if (spu.pc < func.addr || spu.pc >= func.addr + func.size)
+			{
+				return;
+			}
+		}
+
+		if (test(spu.state) && spu.check_state())
+		{
+			return;
+		}
+	}
+}
+
 spu_recompiler_base::~spu_recompiler_base()
 {
 }
@@ -32,19 +143,34 @@ void spu_recompiler_base::enter(SPUThread& spu)
 		return;
 	}
 
-	if (!func->compiled)
+	auto compiled = func->compiled.load();
+
+	if (!compiled && g_cfg_spu_async_compile)
+	{
+		if (!func->queued.exchange(true))
+		{
+			fxm::get_always<spu_async_compiler>()->push(func);
+		}
+
+		return spu_interpret(spu, _ls, *func);
+	}
+
+	if (!compiled)
 	{
 		if (!spu.spu_rec)
 		{
-			spu.spu_rec = fxm::get_always<spu_recompiler>();
+			// Each SPU thread has its own recompiler instance
+			spu.spu_rec = std::make_shared<spu_recompiler>();
 		}
 
 		spu.spu_rec->compile(*func);
 
-		if (!func->compiled) fmt::throw_exception("Compilation failed" HERE);
+		compiled = func->compiled.load();
+
+		if (!compiled) fmt::throw_exception("Compilation failed" HERE);
 	}
 
-	const u32 res = func->compiled(&spu, _ls);
+	const u32 res = compiled(&spu, _ls);
 
 	if (const auto exception = spu.pending_exception)
 	{
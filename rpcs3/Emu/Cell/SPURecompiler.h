@@ -8,7 +8,7 @@
 class spu_recompiler_base
 {
 protected:
-	std::mutex m_mutex; // must be locked in compile()
+	std::mutex m_mutex; // must be locked in compile() (protects the instance state, not the function)
 
 	const spu_function_t* m_func; // current function
 
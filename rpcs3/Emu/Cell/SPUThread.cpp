@@ -226,28 +226,80 @@ void SPUThread::cpu_task()
 		g_cfg_spu_decoder.get() == spu_decoder_type::fast ? &s_spu_interpreter_fast.get_table() :
 		(fmt::throw_exception<std::logic_error>("Invalid SPU decoder"), nullptr));
 
+	itable = table.data();
+
+	// Predecoded instructions (LS may have been modified while the thread wasn't running)
+	if (!icache)
+	{
+		icache.reset(new spu_inter_func_t[0x10000]);
+	}
+
+	std::fill_n(icache.get(), 0x10000, &icache_decode);
+
 	// LS base address
-	const auto base = vm::ps3::_ptr<const u32>(offset);
+	const auto base = vm::ps3::_ptr<const u8>(offset);
+	const auto cache = icache.get();
+	const auto bswap4 = _mm_set_epi8(12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3);
+
+	v128 _op;
 
 	while (true)
 	{
-		if (!test(state))
+		if (UNLIKELY(test(state)))
 		{
-			// Read opcode
-			const u32 op = base[pc / 4];
-
-			// Call interpreter function
-			table[spu_decode(op)](*this, { op });
+			if (check_state()) return;
+			continue;
+		}
 
-			// Next instruction
+		if (pc % 16)
+		{
+			// Unaligned
+			const u32 op = *reinterpret_cast<const be_t<u32>*>(base + pc);
+			cache[pc / 4](*this, {op});
 			pc += 4;
 			continue;
 		}
 
-		if (check_state()) return;
+		// Execute up to four instructions, stop on branch or state change
+		const u32 pos = pc;
+		const auto func0 = cache[pos / 4 + 0];
+		const auto func1 = cache[pos / 4 + 1];
+		const auto func2 = cache[pos / 4 + 2];
+		const auto func3 = cache[pos / 4 + 3];
+		_op.vi = _mm_shuffle_epi8(_mm_load_si128(reinterpret_cast<const __m128i*>(base + pos)), bswap4);
+
+		func0(*this, {_op._u32[0]});
+
+		if (LIKELY(pc == pos && !test(state)))
+		{
+			pc += 4;
+			func1(*this, {_op._u32[1]});
+
+			if (LIKELY(pc == pos + 4 && !test(state)))
+			{
+				pc += 4;
+				func2(*this, {_op._u32[2]});
+
+				if (LIKELY(pc == pos + 8 && !test(state)))
+				{
+					pc += 4;
+					func3(*this, {_op._u32[3]});
+				}
+			}
+		}
+
+		// Next instruction
+		pc += 4;
 	}
 }
 
+void SPUThread::icache_decode(SPUThread& spu, spu_opcode_t op)
+{
+	const auto func = spu.itable[spu_decode(op.opcode)];
+	spu.icache[spu.pc / 4] = func;
+	func(spu, op);
+}
+
 SPUThread::~SPUThread()
 {
 	// Deallocate Local Storage
@@ -307,6 +359,11 @@ void SPUThread::do_dma_transfer(const spu_mfc_cmd& args, bool from_mfc)
 			if (offset + args.size - 1 < 0x40000) // LS access
 			{
 				eal = spu.offset + offset; // redirect access
+
+				if (!is_get)
+				{
+					spu.invalidate_icache(offset, args.size);
+				}
 			}
 			else if (!is_get && args.size == 4 && (offset == SYS_SPU_THREAD_SNR1 || offset == SYS_SPU_THREAD_SNR2))
 			{
@@ -324,7 +381,7 @@ void SPUThread::do_dma_transfer(const spu_mfc_cmd& args, bool from_mfc)
 		}
 	}
 
-	if (args.cmd & (MFC_BARRIER_MASK | MFC_FENCE_MASK)) _mm_mfence();
+	// Fence and barrier flags need no host barrier: commands are executed in order
 
 	void* dst = vm::base(eal);
 	void* src = vm::base(offset + lsa);
@@ -332,6 +389,7 @@ void SPUThread::do_dma_transfer(const spu_mfc_cmd& args, bool from_mfc)
 	if (is_get)
 	{
 		std::swap(dst, src);
+		invalidate_icache(lsa, args.size);
 	}
 
 	switch (u32 size = args.size)
@@ -454,13 +512,81 @@ void SPUThread::do_dma_transfer(const spu_mfc_cmd& args, bool from_mfc)
 	}
 }
 
+u32 SPUThread::get_list_transfer(spu_mfc_cmd& list, spu_mfc_cmd& transfer, u32 max_size, bool& stall)
+{
+	list.lsa &= 0x3fff0;
+
+	transfer.cmd = MFC(list.cmd & ~MFC_LIST_MASK);
+	transfer.tag = list.tag;
+	transfer.size = 0;
+	transfer.lsa = list.lsa;
+	transfer.eal = 0;
+	transfer.eah = 0;
+
+	stall = false;
+
+	u32 count = 0;
+
+	// Merge contiguous elements (adjacent both in LS and in main memory) into a single transfer
+	while (list.size && !stall)
+	{
+		const spu_mfc_list_element item = _ref<spu_mfc_list_element>(list.eal & 0x3fff8);
+
+		const u32 size = item.ts;
+		const u32 addr = item.ea;
+
+		if (size && transfer.size)
+		{
+			if (size % 16 || transfer.size % 16 || addr != transfer.eal + transfer.size || transfer.size + size > max_size || u64{addr} + size > SYS_SPU_THREAD_BASE_LOW)
+			{
+				break;
+			}
+
+			transfer.size += size;
+		}
+		else if (size)
+		{
+			transfer.eal = addr;
+			transfer.lsa = list.lsa | (addr & 0xf);
+			transfer.size = size;
+		}
+
+		stall = (item.sb & 0x8000) != 0;
+		list.eal += 8;
+		list.size -= 8;
+		count++;
+	}
+
+	if (transfer.size)
+	{
+		list.lsa += std::max<u32>(transfer.size, 16);
+	}
+
+	return count;
+}
+
+u32 SPUThread::get_mfc_completed()
+{
+	u32 completed = ch_tag_mask;
+
+	for (u32 i = 0; i < 32; i++)
+	{
+		if (completed & (1u << i) && mfc_tag_count[i])
+		{
+			completed &= ~(1u << i);
+		}
+	}
+
+	return completed;
+}
+
 void SPUThread::process_mfc_cmd()
 {
 	LOG_TRACE(SPU, "DMAC: cmd=%s, lsa=0x%x, ea=0x%llx, tag=0x%x, size=0x%x", ch_mfc_cmd.cmd, ch_mfc_cmd.lsa, ch_mfc_cmd.eal, ch_mfc_cmd.tag, ch_mfc_cmd.size);
 
 	const auto mfc = fxm::check_unlocked<mfc_thread>();
 
-	// Check queue size
+	// Wait for a free queue slot (MFC thread notifies after popping from the full queue)
 	while (mfc_queue.size() >= 16)
 	{
 		if (test(state, cpu_flag::stop + cpu_flag::dbg_global_stop))
@@ -468,9 +594,7 @@ void SPUThread::process_mfc_cmd()
 			return;
 		}
 
-		// TODO: investigate lost notifications
-		busy_wait();
-		_mm_lfence();
+		thread_ctrl::wait_for(1000);
 	}
 
 	switch (ch_mfc_cmd.cmd)
@@ -525,12 +649,20 @@ void SPUThread::process_mfc_cmd()
 		{
 			// TODO: vm::check_addr
 			vm::reader_lock lock;
-			rtime = vm::reservation_acquire(raddr, 128);
-			rdata = data;
+
+			// The line may still be updated without the vm lock (lock-free PPU stores), retry until the copy is consistent
+			do
+			{
+				rtime = vm::reservation_acquire(raddr, 128);
+				rdata = data;
+				_mm_lfence();
+			}
+			while (UNLIKELY(vm::reservation_acquire(raddr, 128) != rtime));
 		}
 
 		// Copy to LS
 		_ref<decltype(rdata)>(ch_mfc_cmd.lsa & 0x3ffff) = rdata;
+		invalidate_icache(ch_mfc_cmd.lsa & 0x3ffff, 128);
 
 		return ch_atomic_stat.set_value(MFC_GETLLAR_SUCCESS);
 	}
@@ -548,18 +680,26 @@ void SPUThread::process_mfc_cmd()
 			// TODO: vm::check_addr
 			vm::writer_lock lock;
 
-			if (rtime == vm::reservation_acquire(raddr, 128) && rdata == data)
+			if (vm::reservation_trylock(raddr, rtime))
 			{
-				data = to_write;
-				result = true;
+				if (rdata == data)
+				{
+					data = to_write;
+					result = true;
 
-				vm::reservation_update(raddr, 128);
-				vm::notify(raddr, 128);
+					vm::reservation_update(raddr, 128);
+				}
+				else
+				{
+					vm::reservation_unlock(raddr, rtime);
+				}
 			}
 		}
 
 		if (result)
 		{
+			// Notify waiters outside of the vm writer lock
+			vm::notify(raddr, 128);
 			ch_atomic_stat.set_value(MFC_PUTLLC_SUCCESS);
 		}
 		else
@@ -588,9 +728,13 @@ void SPUThread::process_mfc_cmd()
 
 		// Store unconditionally
 		// TODO: vm::check_addr
-		vm::writer_lock lock(0);
-		data = to_write;
-		vm::reservation_update(ch_mfc_cmd.eal, 128);
+		{
+			vm::writer_lock lock(0);
+			vm::reservation_lock(ch_mfc_cmd.eal, 128);
+			data = to_write;
+			vm::reservation_update(ch_mfc_cmd.eal, 128);
+		}
+
 		vm::notify(ch_mfc_cmd.eal, 128);
 
 		ch_atomic_stat.set_value(MFC_PUTLLUC_SUCCESS);
@@ -659,58 +803,35 @@ void SPUThread::process_mfc_cmd()
 				break;
 			}
 
-			struct list_element
-			{
-				be_t<u16> sb;
-				be_t<u16> ts;
-				be_t<u32> ea;
-			};
-			
 			u32 total_size = 0;
 
 			while (ch_mfc_cmd.size && total_size < 256)
 			{
-				ch_mfc_cmd.lsa &= 0x3fff0;
+				spu_mfc_cmd list = ch_mfc_cmd;
+				spu_mfc_cmd transfer;
+				bool stall;
 
-				const list_element item = _ref<list_element>(ch_mfc_cmd.eal & 0x3fff8);
+				get_list_transfer(list, transfer, 256 - total_size, stall);
 
-				if (item.sb & 0x8000)
+				// Leave stall-and-notify elements to the MFC thread
+				if (stall || total_size + transfer.size > 256)
 				{
 					break;
 				}
 
-				const u32 size = item.ts;
-				const u32 addr = item.ea;
-
-				if (size)
+				if (transfer.size)
 				{
-					if (total_size + size > 256)
-					{
-						break;
-					}
-
-					if (!vm::check_addr(addr, size, vm::page_readable | (ch_mfc_cmd.cmd & MFC_PUT_CMD ? vm::page_writable : 0)))
+					if (!vm::check_addr(transfer.eal, transfer.size, vm::page_readable | (ch_mfc_cmd.cmd & MFC_PUT_CMD ? vm::page_writable : 0)))
 					{
 						// TODO
 						break;
 					}
 
-					spu_mfc_cmd transfer;
-					transfer.eal = addr;
-					transfer.eah = 0;
-					transfer.lsa = ch_mfc_cmd.lsa | (addr & 0xf);
-					transfer.tag = ch_mfc_cmd.tag;
-					transfer.cmd = MFC(ch_mfc_cmd.cmd & ~MFC_LIST_MASK);
-					transfer.size = size;
-
 					do_dma_transfer(transfer);
-					const u32 add_size = std::max<u32>(size, 16);
-					ch_mfc_cmd.lsa += add_size;
-					total_size += add_size;
+					total_size += std::max<u32>(transfer.size, 16);
 				}
 
-				ch_mfc_cmd.eal += 8;
-				ch_mfc_cmd.size -= 8;
+				ch_mfc_cmd = list;
 			}
 
 			if (ch_mfc_cmd.size == 0)
@@ -729,7 +850,11 @@ void SPUThread::process_mfc_cmd()
 
 		if (mfc_queue.size() == 0)
 		{
-			_mm_mfence();
+			if (ch_mfc_cmd.cmd == MFC_SYNC_CMD)
+			{
+				_mm_mfence();
+			}
+
 			return;
 		}
 
@@ -742,6 +867,7 @@ void SPUThread::process_mfc_cmd()
 	}
 
 	// Enqueue
+	mfc_tag_count[ch_mfc_cmd.tag & 0x1f]++;
 	verify(HERE), mfc_queue.try_push(ch_mfc_cmd);
 
 	//if (test(mfc->state, cpu_flag::is_waiting))
@@ -1177,26 +1303,22 @@ bool SPUThread::set_ch_value(u32 ch, u32 value)
 		}
 
 		ch_tag_stat.set_value(0, false);
-		ch_tag_upd = value;
 
-		if (mfc_queue.size() == 0 && (!value || ch_tag_upd.exchange(0)))
+		if (value == MFC_TAG_UPDATE_IMMEDIATE)
 		{
-			ch_tag_stat.set_value(ch_tag_mask);
+			// Cancel the pending ANY/ALL request
+			ch_tag_upd = 0;
+			ch_tag_stat.set_value(get_mfc_completed());
+			return true;
 		}
-		else if (!value)
-		{
-			u32 completed = ch_tag_mask;
 
-			for (u32 i = 0; completed && i < 16; i++)
-			{
-				const auto& _cmd = mfc_queue.get_push(i);
+		ch_tag_upd = value;
 
-				if (_cmd.size)
-				{
-					completed &= ~(1u << _cmd.tag);
-				}
-			}
+		// Check completion (the MFC thread repeats the check after decrementing tag counters)
+		const u32 completed = get_mfc_completed();
 
+		if (completed && (value == MFC_TAG_UPDATE_ANY || completed == ch_tag_mask) && ch_tag_upd.exchange(0))
+		{
 			ch_tag_stat.set_value(completed);
 		}
 		else
@@ -534,6 +534,9 @@ public:
 	// MFC command proxy queue (consumer: MFC thread)
 	lf_mpsc<spu_mfc_cmd, 8> mfc_proxy;
 
+	// Number of enqueued MFC commands per tag group (decremented by MFC thread)
+	std::array<atomic_t<u8>, 32> mfc_tag_count{};
+
 	// Reservation Data
 	u64 rtime = 0;
 	std::array<u128, 8> rdata{};
@@ -585,8 +588,31 @@ public:
 	std::shared_ptr<class spu_recompiler_base> spu_rec;
 	u32 recursion_level = 0;
 
+	// Interpreter: predecoded handlers for every LS instruction (nullptr if not used)
+	std::unique_ptr<spu_inter_func_t[]> icache;
+
+	// Interpreter: opcode table used to fill icache
+	const spu_inter_func_t* itable = nullptr;
+
+	// Interpreter: decode the instruction at pc, store the handler in icache and execute it
+	static void icache_decode(SPUThread& spu, spu_opcode_t op);
+
+	// Interpreter: reset predecoded instructions after LS modification
+	void invalidate_icache(u32 lsa, u32 size)
+	{
+		if (icache)
+		{
+			for (u32 i = lsa / 4, end = (lsa + size + 3) / 4; i < end; i++)
+			{
+				icache[i % 0x10000] = &icache_decode;
+			}
+		}
+	}
+
 	void push_snr(u32 number, u32 value);
 	void do_dma_transfer(const spu_mfc_cmd& args, bool from_mfc = true);
+	u32 get_list_transfer(spu_mfc_cmd& list, spu_mfc_cmd& transfer, u32 max_size, bool& stall);
+	u32 get_mfc_completed();
 
 	void process_mfc_cmd();
 	u32 get_events(bool waiting = false);
@@ -1032,6 +1032,167 @@ DECLARE(lv2_obj::g_waiting);
 // Amount of PPU threads running simultaneously (must be 2)
 cfg::int_entry<1, 16> g_cfg_ppu_threads(cfg::root.core, "PPU Threads", 2);
 
+DECLARE(lv2_sleep_queue::g_prio_epoch){0};
+
+u32 lv2_sleep_queue::get_prio(cpu_thread* cpu)
+{
+	return cpu->id_type() == 1 ? static_cast<ppu_thread*>(cpu)->prio.load() : -1;
+}
+
+void lv2_sleep_queue::place(u32 pos, const entry& e)
+{
+	m_heap[pos] = e;
+	e.cpu->sleep_index = pos;
+}
+
+void lv2_sleep_queue::sift_up(u32 pos)
+{
+	const entry e = m_heap[pos];
+
+	while (pos)
+	{
+		const u32 parent = (pos - 1) / 2;
+
+		if (!less(e, m_heap[parent]))
+		{
+			break;
+		}
+
+		place(pos, m_heap[parent]);
+		pos = parent;
+	}
+
+	place(pos, e);
+}
+
+void lv2_sleep_queue::sift_down(u32 pos)
+{
+	const entry e = m_heap[pos];
+	const u32 size = ::size32(m_heap);
+
+	while (true)
+	{
+		u32 child = pos * 2 + 1;
+
+		if (child >= size)
+		{
+			break;
+		}
+
+		if (child + 1 < size && less(m_heap[child + 1], m_heap[child]))
+		{
+			child++;
+		}
+
+		if (!less(m_heap[child], e))
+		{
+			break;
+		}
+
+		place(pos, m_heap[child]);
+		pos = child;
+	}
+
+	place(pos, e);
+}
+
+void lv2_sleep_queue::refresh()
+{
+	const u32 epoch = g_prio_epoch;
+
+	if (LIKELY(m_epoch == epoch))
+	{
+		return;
+	}
+
+	m_epoch = epoch;
+
+	for (auto& e : m_heap)
+	{
+		e.prio = get_prio(e.cpu);
+	}
+
+	// Rebuild the heap
+	for (u32 pos = ::size32(m_heap) / 2; pos--;)
+	{
+		sift_down(pos);
+	}
+}
+
+void lv2_sleep_queue::emplace_back(cpu_thread* cpu)
+{
+	// Link at the end
+	cpu->sleep_prev = m_last;
+	cpu->sleep_next = nullptr;
+	(m_last ? m_last->sleep_next : m_first) = cpu;
+	m_last = cpu;
+
+	// The queue may be unused since the last priority change
+	if (m_heap.empty())
+	{
+		m_epoch = g_prio_epoch;
+	}
+
+	m_heap.push_back({get_prio(cpu), m_seq++, cpu});
+	sift_up(::size32(m_heap) - 1);
+}
+
+bool lv2_sleep_queue::remove(cpu_thread* cpu)
+{
+	const u32 pos = cpu->sleep_index;
+
+	if (pos >= m_heap.size() || m_heap[pos].cpu != cpu)
+	{
+		return false;
+	}
+
+	// Unlink
+	(cpu->sleep_prev ? cpu->sleep_prev->sleep_next : m_first) = cpu->sleep_next;
+	(cpu->sleep_next ? cpu->sleep_next->sleep_prev : m_last) = cpu->sleep_prev;
+	cpu->sleep_prev = nullptr;
+	cpu->sleep_next = nullptr;
+	cpu->sleep_index = -1;
+
+	// Replace with the last heap entry
+	const entry last = m_heap.back();
+	m_heap.pop_back();
+
+	if (pos < m_heap.size())
+	{
+		place(pos, last);
+
+		if (pos && less(last, m_heap[(pos - 1) / 2]))
+		{
+			sift_up(pos);
+		}
+		else
+		{
+			sift_down(pos);
+		}
+	}
+
+	return true;
+}
+
+cpu_thread* lv2_sleep_queue::pop(u32 protocol)
+{
+	if (m_heap.empty())
+	{
+		return nullptr;
+	}
+
+	cpu_thread* cpu = m_first;
+
+	if (protocol != SYS_SYNC_FIFO)
+	{
+		refresh();
+		cpu = m_heap[0].cpu;
+	}
+
+	remove(cpu);
+	return cpu;
+}
+
 void lv2_obj::sleep_timeout(named_thread& thread, u64 timeout)
 {
 	semaphore_lock lock(g_mutex);
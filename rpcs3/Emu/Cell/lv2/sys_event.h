@@ -85,7 +85,7 @@ struct lv2_event_queue final : public lv2_obj
 
 	semaphore<> mutex;
 	std::deque<lv2_event> events;
-	std::deque<cpu_thread*> sq;
+	lv2_sleep_queue sq;
 
 	lv2_event_queue(u32 protocol, s32 type, u64 name, u64 ipc_key, s32 size)
 		: protocol(protocol)
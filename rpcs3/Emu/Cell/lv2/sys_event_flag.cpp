@@ -239,22 +239,13 @@ error_code sys_event_flag_set(u32 id, u64 bitptn)
 	{
 		semaphore_lock lock(flag->mutex);
 
-		// Sort sleep queue in required order
-		if (flag->protocol != SYS_SYNC_FIFO)
-		{
-			std::stable_sort(flag->sq.begin(), flag->sq.end(), [](cpu_thread* a, cpu_thread* b)
-			{
-				return static_cast<ppu_thread*>(a)->prio < static_cast<ppu_thread*>(b)->prio;
-			});
-		}
-
-		// Process all waiters in single atomic op
+		// Process all waiters in single atomic op (in required order)
 		const u32 count = flag->pattern.atomic_op([&](u64& value)
 		{
 			value |= bitptn;
 			u32 count = 0;
 
-			for (auto cpu : flag->sq)
+			flag->sq.for_each(flag->protocol, [&](cpu_thread* cpu)
 			{
 				auto& ppu = static_cast<ppu_thread&>(*cpu);
 
@@ -266,7 +257,7 @@ error_code sys_event_flag_set(u32 id, u64 bitptn)
 					ppu.gpr[3] = CELL_OK;
 					count++;
 				}
-			}
+			});
 
 			return count;
 		});
@@ -277,7 +268,7 @@ error_code sys_event_flag_set(u32 id, u64 bitptn)
 		}
 
 		// Remove waiters
-		const auto tail = std::remove_if(flag->sq.begin(), flag->sq.end(), [&](cpu_thread* cpu)
+		flag->sq.remove_if(flag->protocol, [&](cpu_thread* cpu)
 		{
 			auto& ppu = static_cast<ppu_thread&>(*cpu);
 
@@ -290,8 +281,6 @@ error_code sys_event_flag_set(u32 id, u64 bitptn)
 
 			return false;
 		});
-
-		flag->sq.erase(tail, flag->sq.end());
 	}
 	
 	return CELL_OK;
@@ -43,7 +43,7 @@ struct lv2_event_flag final : lv2_obj
 	semaphore<> mutex;
 	atomic_t<u32> waiters{0};
 	atomic_t<u64> pattern;
-	std::deque<cpu_thread*> sq;
+	lv2_sleep_queue sq;
 
 	lv2_event_flag(u32 protocol, s32 type, u64 name, u64 pattern)
 		: protocol(protocol)
@@ -1,7 +1,9 @@
 #include "stdafx.h"
+#include "Utilities/Config.h"
 #include "sys_fs.h"
 
 #include <mutex>
+#include <list>
 
 #include "Emu/Cell/PPUThread.h"
 #include "Crypto/unedat.h"
@@ -13,6 +15,8 @@ namespace vm { using namespace ps3; }
 
 logs::channel sys_fs("sys_fs", logs::level::notice);
 
+cfg::bool_entry g_cfg_fs_mmap_reads(cfg::root.vfs, "Memory-mapped game data reads");
+
 struct lv2_fs_mount_point
 {
 	std::mutex mutex;
@@ -56,6 +60,82 @@ bool verify_mself(u32 fd, fs::file const& mself_file)
 	return true;
 }
 
+// Memory mappings of read-only game data, kept alive across open/close cycles
+struct lv2_fs_map_cache
+{
+	static const std::size_t max_count = 64;
+
+	std::mutex mutex;
+
+	// Most recently used first
+	std::list<std::pair<std::string, std::shared_ptr<const fs::file_map>>> maps;
+
+	// Check whether the file is located on the read-only game data mount
+	// (files on writable mounts may be truncated while mapped, which makes reads fault)
+	static bool is_mappable(const char* vpath)
+	{
+		return !std::strncmp(vpath, "/dev_bdvd/", 10);
+	}
+
+	std::shared_ptr<const fs::file_map> get(const std::string& local_path)
+	{
+		fs::stat_t info;
+
+		if (!fs::stat(local_path, info) || info.is_directory)
+		{
+			return nullptr;
+		}
+
+		std::lock_guard<std::mutex> lock(mutex);
+
+		for (auto it = maps.begin(); it != maps.end(); it++)
+		{
+			if (it->first == local_path)
+			{
+				if (it->second->info().size == info.size && it->second->info().mtime == info.mtime)
+				{
+					maps.splice(maps.begin(), maps, it);
+					return maps.front().second;
+				}
+
+				// File was modified
+				maps.erase(it);
+				break;
+			}
+		}
+
+		auto map = std::make_shared<fs::file_map>();
+
+		if (!map->open(local_path))
+		{
+			return nullptr;
+		}
+
+		maps.emplace_front(local_path, map);
+
+		if (maps.size() > max_count)
+		{
+			maps.pop_back();
+		}
+
+		return map;
+	}
+
+	// Drop the cached mapping (opened files keep their own reference)
+	static void evict(const std::string& local_path)
+	{
+		if (const auto cache = fxm::get<lv2_fs_map_cache>())
+		{
+			std::lock_guard<std::mutex> lock(cache->mutex);
+
+			cache->maps.remove_if([&](const auto& pair)
+			{
+				return pair.first == local_path;
+			});
+		}
+	}
+};
+
 lv2_fs_mount_point* lv2_fs_object::get_mp(const char* filename)
 {
 	// TODO
@@ -64,6 +144,12 @@ lv2_fs_mount_point* lv2_fs_object::get_mp(const char* filename)
 
 u64 lv2_file::op_read(vm::ps3::ptr<void> buf, u64 size)
 {
+	if (mapped)
+	{
+		// Plain copy from the mapped view
+		return file.read(buf.get_ptr(), size);
+	}
+
 	// Copy data from intermediate buffer (avoid passing vm pointer to a native API)
 	std::unique_ptr<u8[]> local_buf(new u8[size]);
 	const u64 result = file.read(local_buf.get(), size);
@@ -71,6 +157,24 @@ u64 lv2_file::op_read(vm::ps3::ptr<void> buf, u64 size)
 	return result;
 }
 
+bool lv2_file::op_read_at(u64 offset, vm::ps3::ptr<void> buf, u64 size, u64& result) const
+{
+	if (mapped)
+	{
+		return file.read_at(offset, buf.get_ptr(), size, result);
+	}
+
+	std::unique_ptr<u8[]> local_buf(new u8[size]);
+
+	if (!file.read_at(offset, local_buf.get(), size, result))
+	{
+		return false;
+	}
+
+	std::memcpy(buf.get_ptr(), local_buf.get(), result);
+	return true;
+}
+
 u64 lv2_file::op_write(vm::ps3::cptr<void> buf, u64 size)
 {
 	// Copy data to intermediate buffer (avoid passing vm pointer to a native API)
@@ -238,7 +342,26 @@ error_code sys_fs_open(vm::cptr<char> path, s32 flags, vm::ptr<u32> fd, s32 mode
 		fmt::throw_exception("sys_fs_open(%s): Invalid or unimplemented flags: %#o" HERE, path, flags);
 	}
 
-	fs::file file(local_path, open_mode);
+	fs::file file;
+	bool mapped = false;
+
+	if (test(open_mode & fs::write))
+	{
+		lv2_fs_map_cache::evict(local_path);
+	}
+	else if (g_cfg_fs_mmap_reads && lv2_fs_map_cache::is_mappable(path.get_ptr()))
+	{
+		if (const auto map = fxm::get_always<lv2_fs_map_cache>()->get(local_path))
+		{
+			file = fs::file(map);
+			mapped = true;
+		}
+	}
+
+	if (!file)
+	{
+		file.open(local_path, open_mode);
+	}
 
 	if (!file)
 	{
@@ -275,6 +398,7 @@ error_code sys_fs_open(vm::cptr<char> path, s32 flags, vm::ptr<u32> fd, s32 mode
 				}
 
 				file.reset(std::move(sdata_file));
+				mapped = false;
 			}
 		}
 		// edata 
@@ -295,10 +419,11 @@ error_code sys_fs_open(vm::cptr<char> path, s32 flags, vm::ptr<u32> fd, s32 mode
 				}
 
 				file.reset(std::move(sdata_file));
+				mapped = false;
 			}
 		}
 	}
-	if (const u32 id = idm::make<lv2_fs_object, lv2_file>(path.get_ptr(), std::move(file), mode, flags))
+	if (const u32 id = idm::make<lv2_fs_object, lv2_file>(path.get_ptr(), std::move(file), mode, flags, mapped))
 	{
 		*fd = id;
 		return CELL_OK;
@@ -534,7 +659,13 @@ error_code sys_fs_rename(vm::cptr<char> from, vm::cptr<char> to)
 {
 	sys_fs.warning("sys_fs_rename(from=%s, to=%s)", from, to);
 
-	if (!fs::rename(vfs::get(from.get_ptr()), vfs::get(to.get_ptr())))
+	const std::string local_from = vfs::get(from.get_ptr());
+	const std::string local_to = vfs::get(to.get_ptr());
+
+	lv2_fs_map_cache::evict(local_from);
+	lv2_fs_map_cache::evict(local_to);
+
+	if (!fs::rename(local_from, local_to))
 	{
 		return CELL_ENOENT; // ???
 	}
@@ -566,7 +697,11 @@ error_code sys_fs_unlink(vm::cptr<char> path)
 {
 	sys_fs.warning("sys_fs_unlink(path=%s)", path);
 
-	if (!fs::remove_file(vfs::get(path.get_ptr())))
+	const std::string local_path = vfs::get(path.get_ptr());
+
+	lv2_fs_map_cache::evict(local_path);
+
+	if (!fs::remove_file(local_path))
 	{
 		switch (auto error = fs::g_tls_error)
 		{
@@ -730,7 +865,11 @@ error_code sys_fs_truncate(vm::cptr<char> path, u64 size)
 {
 	sys_fs.warning("sys_fs_truncate(path=%s, size=0x%llx)", path, size);
 
-	if (!fs::truncate_file(vfs::get(path.get_ptr()), size))
+	const std::string local_path = vfs::get(path.get_ptr());
+
+	lv2_fs_map_cache::evict(local_path);
+
+	if (!fs::truncate_file(local_path, size))
 	{
 		switch (auto error = fs::g_tls_error)
 		{
@@ -138,11 +138,15 @@ struct lv2_file final : lv2_fs_object
 	const s32 mode;
 	const s32 flags;
 
-	lv2_file(const char* filename, fs::file&& file, s32 mode, s32 flags)
+	// File is read from the memory mapping (no intermediate buffer needed)
+	const bool mapped;
+
+	lv2_file(const char* filename, fs::file&& file, s32 mode, s32 flags, bool mapped = false)
 		: lv2_fs_object(lv2_fs_object::get_mp(filename))
 		, file(std::move(file))
 		, mode(mode)
 		, flags(flags)
+		, mapped(mapped)
 	{
 	}
 
@@ -151,12 +155,16 @@ struct lv2_file final : lv2_fs_object
 		, file(std::move(file))
 		, mode(mode)
 		, flags(flags)
+		, mapped(false)
 	{
 	}
 
 	// File reading with intermediate buffer
 	u64 op_read(vm::ps3::ptr<void> buf, u64 size);
 
+	// Positional file reading (false if not supported by the file)
+	bool op_read_at(u64 offset, vm::ps3::ptr<void> buf, u64 size, u64& result) const;
+
 	// File writing with intermediate buffer
 	u64 op_write(vm::ps3::cptr<void> buf, u64 size);
 
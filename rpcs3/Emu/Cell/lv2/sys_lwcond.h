@@ -27,7 +27,7 @@ struct lv2_lwcond final : lv2_obj
 	const u32 lwid;
 
 	atomic_t<u32> waiters{0};
-	std::deque<cpu_thread*> sq;
+	lv2_sleep_queue sq;
 
 	lv2_lwcond(u64 name, u32 lwid)
 		: name(name)
@@ -35,7 +35,7 @@ struct lv2_mutex final : lv2_obj
 	atomic_t<u32> owner{0}; // Owner Thread ID
 	atomic_t<u32> lock_count{0}; // Recursive Locks
 	atomic_t<u32> cond_count{0}; // Condition Variables
-	std::deque<cpu_thread*> sq;
+	lv2_sleep_queue sq;
 
 	lv2_mutex(u32 protocol, u32 recursive, u64 name)
 		: protocol(protocol)
@@ -210,6 +210,9 @@ error_code sys_ppu_thread_set_priority(ppu_thread& ppu, u32 thread_id, s32 prio)
 	{
 		if (thread.prio != prio && thread.prio.exchange(prio) != prio)
 		{
+			// Sleep queues must re-read the priority
+			lv2_sleep_queue::g_prio_epoch++;
+
 			lv2_obj::awake(thread, prio);
 		}
 	});
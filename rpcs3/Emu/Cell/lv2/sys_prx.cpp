@@ -12,6 +12,7 @@ namespace vm { using namespace ps3; }
 
 extern std::shared_ptr<lv2_prx> ppu_load_prx(const ppu_prx_object&, const std::string&);
 extern void ppu_initialize(const ppu_module&);
+extern std::shared_ptr<const std::vector<u8>> ppu_decrypt_prx(const std::string&);
 
 logs::channel sys_prx("sys_prx", logs::level::notice);
 
@@ -19,7 +20,9 @@ s32 prx_load_module(std::string path, u64 flags, vm::ptr<sys_prx_load_module_opt
 {
 	sys_prx.warning("prx_load_module(path='%s', flags=0x%llx, pOpt=*0x%x)", path.c_str(), flags, pOpt);
 
-	const ppu_prx_object obj = decrypt_self(fs::file(vfs::get(path)));
+	const auto data = ppu_decrypt_prx(vfs::get(path));
+
+	const ppu_prx_object obj = data ? fs::file(data->data(), data->size()) : fs::file{};
 
 	if (obj != elf_error::ok)
 	{
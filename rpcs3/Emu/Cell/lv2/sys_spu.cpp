@@ -608,6 +608,8 @@ error_code sys_spu_thread_write_ls(u32 id, u32 lsa, u64 value, u32 type)
 	default: return CELL_EINVAL;
 	}
 
+	thread->invalidate_icache(lsa, type);
+
 	return CELL_OK;
 }
 
@@ -9,6 +9,8 @@
 #include "Emu/Cell/ErrorCodes.h"
 
 #include <deque>
+#include <vector>
+#include <algorithm>
 
 // attr_protocol (waiting scheduling policy)
 enum
@@ -49,6 +51,162 @@ enum
 	SYS_SYNC_NOT_ADAPTIVE = 0x2000,
 };
 
+// Queue of threads waiting on a kernel object (intrusive: waiting doesn't allocate memory).
+// Threads are linked in arrival order and indexed by a binary heap of (priority, arrival order).
+class lv2_sleep_queue
+{
+	struct entry
+	{
+		u32 prio; // Thread priority (re-read when g_prio_epoch changes)
+		u64 seq; // Arrival order
+		cpu_thread* cpu;
+	};
+
+	// Priority heap (the position is stored in cpu_thread::sleep_index)
+	std::vector<entry> m_heap;
+
+	// Threads in arrival order (linked via cpu_thread::sleep_prev/sleep_next)
+	cpu_thread* m_first = nullptr;
+	cpu_thread* m_last = nullptr;
+
+	// Next sequence number
+	u64 m_seq = 0;
+
+	// Value of g_prio_epoch when the priorities were read
+	u32 m_epoch = 0;
+
+	static bool less(const entry& lhs, const entry& rhs)
+	{
+		return lhs.prio < rhs.prio || (lhs.prio == rhs.prio && lhs.seq < rhs.seq);
+	}
+
+	static u32 get_prio(cpu_thread* cpu);
+
+	void place(u32 pos, const entry& e);
+	void sift_up(u32 pos);
+	void sift_down(u32 pos);
+
+	// Re-read thread priorities if any of them has changed
+	void refresh();
+
+public:
+	// Advanced when the priority of a thread changes (the priorities of waiting threads are then re-read)
+	static atomic_t<u32> g_prio_epoch;
+
+	lv2_sleep_queue() = default;
+
+	lv2_sleep_queue(const lv2_sleep_queue&) = delete;
+
+	lv2_sleep_queue& operator =(const lv2_sleep_queue&) = delete;
+
+	class const_iterator
+	{
+		cpu_thread* m_cpu;
+
+	public:
+		const_iterator(cpu_thread* cpu)
+			: m_cpu(cpu)
+		{
+		}
+
+		cpu_thread* operator *() const
+		{
+			return m_cpu;
+		}
+
+		const_iterator& operator ++()
+		{
+			m_cpu = m_cpu->sleep_next;
+			return *this;
+		}
+
+		bool operator ==(const const_iterator& rhs) const
+		{
+			return m_cpu == rhs.m_cpu;
+		}
+
+		bool operator !=(const const_iterator& rhs) const
+		{
+			return m_cpu != rhs.m_cpu;
+		}
+	};
+
+	bool empty() const
+	{
+		return m_heap.empty();
+	}
+
+	std::size_t size() const
+	{
+		return m_heap.size();
+	}
+
+	// Iterate in arrival order
+	const_iterator begin() const
+	{
+		return m_first;
+	}
+
+	const_iterator end() const
+	{
+		return nullptr;
+	}
+
+	// Add the thread at the end of the queue (a thread can only wait in one queue at a time)
+	void emplace_back(cpu_thread* cpu);
+
+	// Remove the thread, returns false if not found
+	bool remove(cpu_thread* cpu);
+
+	// Remove and return the first thread according to the protocol
+	cpu_thread* pop(u32 protocol);
+
+	// Call func(cpu_thread*) for each thread in the order defined by the protocol
+	template <typename F>
+	void for_each(u32 protocol, F&& func)
+	{
+		if (protocol == SYS_SYNC_FIFO)
+		{
+			for (cpu_thread* cpu = m_first; cpu; cpu = cpu->sleep_next)
+			{
+				func(cpu);
+			}
+		}
+		else
+		{
+			refresh();
+
+			std::vector<entry> sorted(m_heap);
+			std::sort(sorted.begin(), sorted.end(), less);
+
+			for (const auto& e : sorted)
+			{
+				func(e.cpu);
+			}
+		}
+	}
+
+	// Remove threads for which pred(cpu_thread*) returns true (called in the order defined by the protocol)
+	template <typename F>
+	void remove_if(u32 protocol, F&& pred)
+	{
+		std::vector<cpu_thread*> removed;
+
+		for_each(protocol, [&](cpu_thread* cpu)
+		{
+			if (pred(cpu))
+			{
+				removed.emplace_back(cpu);
+			}
+		});
+
+		for (auto cpu : removed)
+		{
+			remove(cpu);
+		}
+	}
+};
+
 // Base class for some kernel objects (shared set of 8192 objects).
 struct lv2_obj
 {
@@ -73,38 +231,17 @@ struct lv2_obj
 		return false;
 	}
 
-	template <typename E, typename T>
-	static T* schedule(std::deque<T*>& queue, u32 protocol)
+	// Remove the thread from the sleep queue
+	static bool unqueue(lv2_sleep_queue& queue, cpu_thread* object)
 	{
-		if (queue.empty())
-		{
-			return nullptr;
-		}
-
-		if (protocol == SYS_SYNC_FIFO)
-		{
-			const auto res = queue.front();
-			queue.pop_front();
-			return res;
-		}
-
-		u32 prio = -1;
-		auto it = queue.cbegin();
-
-		for (auto found = it, end = queue.cend(); found != end; found++)
-		{
-			const u32 _prio = static_cast<E*>(*found)->prio;
-
-			if (_prio < prio)
-			{
-				it = found;
-				prio = _prio;
-			}
-		}
+		return queue.remove(object);
+	}
 
-		const auto res = *it;
-		queue.erase(it);
-		return res;
+	// Remove and return the thread which must be awaken first
+	template <typename E>
+	static cpu_thread* schedule(lv2_sleep_queue& queue, u32 protocol)
+	{
+		return queue.pop(protocol);
 	}
 
 	// Remove the current thread from the scheduling queue, register timeout
@@ -33,12 +33,68 @@ namespace vm
 	// Memory locations
 	std::vector<std::shared_ptr<block_t>> g_locations;
 
-	// Reservations (lock lines) in a single memory page
+	// Reservations (lock lines) in a single memory page: timestamp (always even) and the lock bit
 	using reservation_info = std::array<std::atomic<u64>, 4096 / 128>;
 
-	// Registered waiters
+	// Waiters of a group of reservation lines (lookup doesn't need a lock)
+	struct alignas(64) waiter_bucket
+	{
+		// Amount of threads scanning the bucket, indexed by the epoch parity they started in
+		std::array<atomic_t<u32>, 2> readers{};
+
+		// Advanced by a removed waiter, so that new notifiers don't delay its wait
+		atomic_t<u32> epoch{0};
+
+		std::array<atomic_t<waiter*>, 6> slots{};
+
+		// Start scanning the bucket, returns the epoch parity to pass to unlock()
+		u32 lock()
+		{
+			while (true)
+			{
+				const u32 epoch = this->epoch % 2;
+
+				readers[epoch]++;
+
+				// Don't hold the counter a remover has started draining
+				if (LIKELY(this->epoch % 2 == epoch))
+				{
+					return epoch;
+				}
+
+				readers[epoch]--;
+			}
+		}
+
+		void unlock(u32 epoch)
+		{
+			readers[epoch]--;
+		}
+	};
+
+	// Registered waiters indexed by reservation line
+	std::array<waiter_bucket, 1024> g_waiter_table{};
+
+	// Registered waiters which didn't fit in their bucket
 	std::deque<vm::waiter*> g_waiters;
 
+	// Protects g_waiters (never held while acquiring g_mutex, so it's safe to notify under vm locks)
+	shared_mutex g_waiters_mutex;
+
+	// Amount of waiters in g_waiters
+	atomic_t<u32> g_waiters_overflow{0};
+
+	// Notification statistics
+	atomic_t<u64> g_notify_calls{0};
+	atomic_t<u64> g_notify_wakeups{0};
+	atomic_t<u64> g_notify_spurious{0};
+
+	static waiter_bucket& get_waiter_bucket(u32 addr)
+	{
+		// Hash reservation line number
+		return g_waiter_table[((addr / 128) * 0x9e3779b1u) >> 22];
+	}
+
 	// Memory mutex core
 	shared_mutex g_mutex;
 
@@ -240,82 +296,231 @@ namespace vm
 
 	u64 reservation_acquire(u32 addr, u32 _size)
 	{
+		auto& res = g_pages[addr >> 12][addr];
+
 		// Access reservation info: stamp and the lock bit
-		return g_pages[addr >> 12][addr].load(std::memory_order_acquire);
+		u64 stamp = res.load(std::memory_order_acquire);
+
+		// The line is only locked for the duration of a single store
+		while (UNLIKELY(stamp & 1))
+		{
+			busy_wait(10);
+			stamp = res.load(std::memory_order_acquire);
+		}
+
+		return stamp;
+	}
+
+	bool reservation_trylock(u32 addr, u64 stamp)
+	{
+		// Fails if the line is locked or the timestamp has changed
+		return g_pages[addr >> 12][addr].compare_exchange_strong(stamp, stamp | 1, std::memory_order_acquire);
+	}
+
+	u64 reservation_lock(u32 addr, u32 _size)
+	{
+		auto& res = g_pages[addr >> 12][addr];
+
+		while (true)
+		{
+			u64 stamp = res.load(std::memory_order_relaxed);
+
+			if (!(stamp & 1) && res.compare_exchange_weak(stamp, stamp | 1, std::memory_order_acquire))
+			{
+				return stamp;
+			}
+
+			busy_wait(10);
+		}
+	}
+
+	void reservation_unlock(u32 addr, u64 stamp)
+	{
+		g_pages[addr >> 12][addr].store(stamp, std::memory_order_release);
 	}
 
 	void reservation_update(u32 addr, u32 _size)
 	{
-		// Update reservation info with new timestamp (unsafe, assume allocated)
-		(*g_pages[addr >> 12].reservations)[(addr & 0xfff) >> 7].store(__rdtsc(), std::memory_order_release);
+		auto& res = g_pages[addr >> 12][addr];
+
+		// Update reservation info with new timestamp (must be greater than the previous one)
+		const u64 stamp = res.load(std::memory_order_relaxed) & ~1ull;
+		res.store(std::max<u64>(__rdtsc() & ~1ull, stamp + 2), std::memory_order_release);
 	}
 
 	void waiter::init()
 	{
 		// Register waiter
-		writer_lock lock(0);
+		g_pages[addr >> 12].waiters++;
+
+		for (auto& slot : get_waiter_bucket(addr).slots)
+		{
+			if (!slot && slot.compare_and_swap_test(nullptr, this))
+			{
+				registered = 1;
+				return;
+			}
+		}
+
+		// The bucket is full
+		::writer_lock lock(g_waiters_mutex);
 
 		g_waiters.emplace_back(this);
+		g_waiters_overflow++;
+		registered = 2;
 	}
 
-	void waiter::test() const
+	bool waiter::test() const
 	{
 		if (std::memcmp(data, vm::base(addr), size) == 0)
 		{
-			return;
+			return false;
 		}
 
 		memory_page& page = g_pages[addr >> 12];
 
 		if (page.reservations == nullptr)
 		{
-			return;
+			return false;
 		}
 
 		if (stamp >= (*page.reservations)[(addr & 0xfff) >> 7].load())
 		{
-			return;
+			return false;
 		}
 
 		if (owner)
 		{
 			owner->notify();
+			return true;
 		}
+
+		return false;
 	}
 
 	waiter::~waiter()
 	{
 		// Unregister waiter
-		writer_lock lock(0);
+		if (registered == 1)
+		{
+			auto& bucket = get_waiter_bucket(addr);
+
+			for (auto& slot : bucket.slots)
+			{
+				if (slot.compare_and_swap_test(this, nullptr))
+				{
+					break;
+				}
+			}
+
+			// Wait for the notifiers which may have seen this waiter: each counter must drop to zero once.
+			// The epoch is advanced before each wait, so that new notifiers use the other counter.
+			const u32 epoch = bucket.epoch++ % 2;
+
+			while (bucket.readers[epoch])
+			{
+				busy_wait(100);
+			}
 
-		// Find waiter
-		const auto found = std::find(g_waiters.cbegin(), g_waiters.cend(), this);
+			bucket.epoch++;
 
-		if (found != g_waiters.cend())
+			while (bucket.readers[epoch ^ 1])
+			{
+				busy_wait(100);
+			}
+
+			g_pages[addr >> 12].waiters--;
+		}
+		else if (registered == 2)
 		{
-			g_waiters.erase(found);
+			::writer_lock lock(g_waiters_mutex);
+
+			// Find waiter
+			const auto found = std::find(g_waiters.cbegin(), g_waiters.cend(), this);
+
+			if (found != g_waiters.cend())
+			{
+				g_waiters.erase(found);
+				g_waiters_overflow--;
+				g_pages[addr >> 12].waiters--;
+			}
 		}
 	}
 
 	void notify(u32 addr, u32 size)
 	{
-		for (const waiter* ptr : g_waiters)
+		// Fast path: no waiters in the page
+		if (!g_pages[addr >> 12].waiters)
 		{
-			if (ptr->addr / 128 == addr / 128)
+			return;
+		}
+
+		g_notify_calls++;
+
+		auto& bucket = get_waiter_bucket(addr);
+
+		const u32 epoch = bucket.lock();
+
+		for (const auto& slot : bucket.slots)
+		{
+			if (const waiter* ptr = slot.load())
 			{
-				ptr->test();
+				if (ptr->addr / 128 == addr / 128)
+				{
+					ptr->test() ? g_notify_wakeups++ : g_notify_spurious++;
+				}
+			}
+		}
+
+		bucket.unlock(epoch);
+
+		if (UNLIKELY(g_waiters_overflow))
+		{
+			::reader_lock lock(g_waiters_mutex);
+
+			for (const waiter* ptr : g_waiters)
+			{
+				if (ptr->addr / 128 == addr / 128)
+				{
+					ptr->test() ? g_notify_wakeups++ : g_notify_spurious++;
+				}
 			}
 		}
 	}
 
 	void notify_all()
 	{
-		for (const waiter* ptr : g_waiters)
+		for (auto& bucket : g_waiter_table)
+		{
+			const u32 epoch = bucket.lock();
+
+			for (const auto& slot : bucket.slots)
+			{
+				if (const waiter* ptr = slot.load())
+				{
+					ptr->test();
+				}
+			}
+
+			bucket.unlock(epoch);
+		}
+
+		if (g_waiters_overflow)
 		{
-			ptr->test();
+			::reader_lock lock(g_waiters_mutex);
+
+			for (const waiter* ptr : g_waiters)
+			{
+				ptr->test();
+			}
 		}
 	}
 
+	notify_stats get_notify_stats()
+	{
+		return {g_notify_calls.load(), g_notify_wakeups.load(), g_notify_spurious.load()};
+	}
+
 	void _page_map(u32 addr, u32 size, u8 flags)
 	{
 		if (!size || (size | addr) % 4096 || flags & page_allocated)
@@ -526,6 +731,7 @@ namespace vm
 
 		// Map "real" memory pages
 		_page_map(addr, size, flags);
+		set_pages((addr - this->addr) / 4096, size / 4096, true);
 
 		// Add entry
 		m_map[addr] = size;
@@ -541,6 +747,95 @@ namespace vm
 		, size(size)
 		, flags(flags)
 	{
+		const u32 count = size / 4096;
+
+		m_pages.resize((count + 63) / 64);
+		m_full.resize((m_pages.size() + 63) / 64);
+
+		// Pages past the end are never free
+		if (count % 64)
+		{
+			set_pages(count, 64 - count % 64, true);
+		}
+	}
+
+	void block_t::set_pages(u32 page, u32 count, bool allocated)
+	{
+		for (u32 end = page + count; page < end;)
+		{
+			const u32 word = page / 64;
+			const u32 bits = std::min<u32>(64 - page % 64, end - page);
+			const u64 mask = (bits == 64 ? ~0ull : ((1ull << bits) - 1)) << (page % 64);
+
+			if (allocated)
+			{
+				m_pages[word] |= mask;
+			}
+			else
+			{
+				m_pages[word] &= ~mask;
+			}
+
+			if (m_pages[word] == ~0ull)
+			{
+				m_full[word / 64] |= 1ull << (word % 64);
+			}
+			else
+			{
+				m_full[word / 64] &= ~(1ull << (word % 64));
+			}
+
+			page += bits;
+		}
+	}
+
+	u32 block_t::find_free_page(u32 page) const
+	{
+		const u32 count = size / 4096;
+
+		for (u32 word = page / 64; page < count; word = page / 64)
+		{
+			// Free pages in the current word
+			if (const u64 free = ~m_pages[word] & (~0ull << (page % 64)))
+			{
+				return std::min<u32>(word * 64 + cnttz64(free, true), count);
+			}
+
+			// Skip full words
+			u32 next = word + 1;
+
+			while (next < m_pages.size())
+			{
+				const u64 full = ~m_full[next / 64] >> (next % 64);
+
+				if (full)
+				{
+					next += cnttz64(full, true);
+					break;
+				}
+
+				next = ::align(next + 1, 64);
+			}
+
+			page = next * 64;
+		}
+
+		return count;
+	}
+
+	u32 block_t::find_used_page(u32 page, u32 end) const
+	{
+		while (page < end)
+		{
+			if (const u64 used = m_pages[page / 64] & (~0ull << (page % 64)))
+			{
+				return std::min<u32>(page / 64 * 64 + cnttz64(used, true), end);
+			}
+
+			page = ::align(page + 1, 64);
+		}
+
+		return end;
 	}
 
 	block_t::~block_t()
@@ -584,13 +879,41 @@ namespace vm
 			pflags |= page_64k_size;
 		}
 
-		// Search for an appropriate place (unoptimized)
-		for (u32 addr = ::align(this->addr, align); addr < this->addr + this->size - 1; addr += align)
+		const u32 count = this->size / 4096;
+		const u32 pages = size / 4096;
+		const u32 step = align / 4096;
+
+		// First page with required alignment
+		const u32 first = (::align<u64>(this->addr, align) - this->addr) / 4096;
+
+		// Search for an appropriate place: skip to the next free page, then to the next allocated page
+		for (u32 page = first; page < count;)
 		{
-			if (try_alloc(addr, size, pflags, sup))
+			page = find_free_page(page);
+
+			// Align candidate
+			page = first + ::align<u64>(std::max(page, first) - first, step);
+
+			if (page >= count || pages > count - page)
 			{
-				return addr;
+				break;
 			}
+
+			const u32 used = find_used_page(page, page + pages);
+
+			if (used == page + pages)
+			{
+				if (try_alloc(this->addr + page * 4096, size, pflags, sup))
+				{
+					return this->addr + page * 4096;
+				}
+
+				// Mapped without block (shouldn't happen)
+				page += step;
+				continue;
+			}
+
+			page = used + 1;
 		}
 
 		return 0;
@@ -641,6 +964,7 @@ namespace vm
 
 			// Unmap "real" memory pages
 			_page_unmap(addr, size);
+			set_pages((addr - this->addr) / 4096, size / 4096, false);
 
 			// Write supplementary info if necessary
 			if (sup_out) *sup_out = m_sup[addr];
@@ -802,6 +1126,11 @@ namespace vm
 
 	void close()
 	{
+		if (const u64 calls = g_notify_calls.exchange(0))
+		{
+			LOG_NOTICE(MEMORY, "vm::notify(): %llu calls, %llu wakeups, %llu spurious", calls, g_notify_wakeups.exchange(0), g_notify_spurious.exchange(0));
+		}
+
 		g_locations.clear();
 
 		utils::memory_decommit(g_base_addr, 0x100000000);
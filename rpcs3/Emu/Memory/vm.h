@@ -44,12 +44,17 @@ namespace vm
 		u64 stamp;
 		const void* data;
 
+		// 0: not registered, 1: in the waiter table, 2: in the overflow list
+		u8 registered = 0;
+
 		waiter() = default;
 
 		waiter(const waiter&) = delete;
 
 		void init();
-		void test() const;
+
+		// Notify the owner if the data has changed (returns true if notified)
+		bool test() const;
 
 		~waiter();
 	};
@@ -98,10 +103,19 @@ namespace vm
 		explicit operator bool() const { return locked; }
 	};
 
-	// Get reservation status for further atomic update: last update timestamp
+	// Get reservation status for further atomic update: last update timestamp (waits if the line is locked)
 	u64 reservation_acquire(u32 addr, u32 size);
 
-	// End atomic update
+	// Lock the reservation line if it wasn't updated since the timestamp was acquired
+	bool reservation_trylock(u32 addr, u64 stamp);
+
+	// Lock the reservation line unconditionally, return current timestamp
+	u64 reservation_lock(u32 addr, u32 size);
+
+	// Unlock the reservation line without updating the timestamp
+	void reservation_unlock(u32 addr, u64 stamp);
+
+	// End atomic update: set new timestamp and unlock the reservation line
 	void reservation_update(u32 addr, u32 size);
 
 	// Check and notify memory changes at address
@@ -110,6 +124,16 @@ namespace vm
 	// Check and notify memory changes
 	void notify_all();
 
+	// Waiter notification statistics
+	struct notify_stats
+	{
+		u64 calls; // notify() calls which found waiters in the page
+		u64 wakeups; // Waiters woken up
+		u64 spurious; // Waiters tested without being woken up
+	};
+
+	notify_stats get_notify_stats();
+
 	// Change memory protection of specified memory region
 	bool page_protect(u32 addr, u32 size, u8 flags_test = 0, u8 flags_set = 0, u8 flags_clear = 0);
 
@@ -134,8 +158,20 @@ namespace vm
 		std::map<u32, u32> m_map; // Mapped memory: addr -> size
 		std::unordered_map<u32, u32> m_sup; // Supplementary info for allocations
 
+		std::vector<u64> m_pages; // Allocated 4K pages (bit per page, pages past the end are set)
+		std::vector<u64> m_full; // Fully allocated words of m_pages (bit per word)
+
 		bool try_alloc(u32 addr, u32 size, u8 flags, u32 sup);
 
+		// Mark pages as allocated or free
+		void set_pages(u32 page, u32 count, bool allocated);
+
+		// Get index of the first free page starting from specified page (or page count)
+		u32 find_free_page(u32 page) const;
+
+		// Get index of the first allocated page in the range (or end)
+		u32 find_used_page(u32 page, u32 end) const;
+
 	public:
 		block_t(u32 addr, u32 size, u64 flags = 0);
 
@@ -2083,7 +2083,7 @@ void arm_interpreter::STREX(ARMv7Thread& cpu, const u32 op, const u32 cond)
 
 		atomic_le_t<u32>& data = vm::_ref<atomic_le_t<u32>>(addr);
 
-		if (cpu.raddr != addr || cpu.rdata != data.load())
+		if (cpu.raddr != addr || cpu.rdata != data.load() || !vm::reservation_trylock(addr, cpu.rtime))
 		{
 			// Failure
 			cpu.raddr = 0;
@@ -2091,14 +2091,16 @@ void arm_interpreter::STREX(ARMv7Thread& cpu, const u32 op, const u32 cond)
 			return;
 		}
 
-		vm::writer_lock lock(0);
-
-		const bool result = cpu.rtime == vm::reservation_acquire(addr, cpu.rtime) && data.compare_and_swap_test(cpu.rdata, value);
+		const bool result = data.compare_and_swap_test(cpu.rdata, value);
 
 		if (result)
 		{
 			vm::reservation_update(addr, sizeof(u32));
 		}
+		else
+		{
+			vm::reservation_unlock(addr, cpu.rtime);
+		}
 		
 		cpu.raddr = 0;
 		cpu.write_gpr(d, !result, 4);
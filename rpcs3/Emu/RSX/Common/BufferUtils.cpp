@@ -32,6 +32,81 @@ namespace
 		return{ X, Y, Z, 1 };
 	}
 
+	// Shuffle masks for byteswapping 16-bit and 32-bit values
+	template <typename T>
+	inline __m128i get_bswap_mask()
+	{
+		return sizeof(T) == 2
+			? _mm_set_epi8(14, 15, 12, 13, 10, 11, 8, 9, 6, 7, 4, 5, 2, 3, 0, 1)
+			: _mm_set_epi8(12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3);
+	}
+
+	// Byteswap tightly packed array of big-endian values
+	template <typename T>
+	void copy_data_swap(void* dst, const void* src, u32 count)
+	{
+		const auto dst_ptr = static_cast<u8*>(dst);
+		const auto src_ptr = static_cast<const u8*>(src);
+		const __m128i mask = get_bswap_mask<T>();
+
+		u32 i = 0;
+
+		for (; i + 16 / sizeof(T) <= count; i += 16 / sizeof(T))
+		{
+			const __m128i vector = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src_ptr + i * sizeof(T)));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst_ptr + i * sizeof(T)), _mm_shuffle_epi8(vector, mask));
+		}
+
+		for (; i < count; i++)
+		{
+			reinterpret_cast<T*>(dst_ptr)[i] = reinterpret_cast<const be_t<T>*>(src_ptr)[i];
+		}
+	}
+
+	// Gather and byteswap 16-byte attributes (vec4 of 32-bit values or vec8 of 16-bit values)
+	template <typename T>
+	void copy_data_swap_vec4(gsl::span<gsl::byte> dst, gsl::span<const gsl::byte> src, u32 dst_stride, u32 src_stride, u32 count)
+	{
+		verify(HERE), dst.size_bytes() >= (count - 1) * dst_stride + 16, src.size_bytes() >= (count - 1) * src_stride + 16;
+
+		const auto dst_ptr = reinterpret_cast<u8*>(dst.data());
+		const auto src_ptr = reinterpret_cast<const u8*>(src.data());
+		const __m128i mask = get_bswap_mask<T>();
+
+		for (u32 i = 0; i < count; i++)
+		{
+			const __m128i vector = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src_ptr + i * src_stride));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst_ptr + i * dst_stride), _mm_shuffle_epi8(vector, mask));
+		}
+	}
+
+	// Try vectorized paths for 16-bit and 32-bit attributes, returns false if not applicable
+	template <typename T>
+	bool copy_attribute_array_fast(gsl::span<gsl::byte> dst, gsl::span<const gsl::byte> src, u32 attribute_size, u32 dst_stride, u32 src_stride, u32 count)
+	{
+		const u32 element_size = attribute_size * sizeof(T);
+
+		if (count == 0)
+		{
+			return true;
+		}
+
+		if (src_stride == element_size && dst_stride == element_size)
+		{
+			verify(HERE), dst.size_bytes() >= count * element_size, src.size_bytes() >= count * element_size;
+			copy_data_swap<T>(dst.data(), src.data(), count * attribute_size);
+			return true;
+		}
+
+		if (element_size == 16 && src_stride && dst_stride >= 16)
+		{
+			copy_data_swap_vec4<T>(dst, src, dst_stride, src_stride, count);
+			return true;
+		}
+
+		return false;
+	}
+
 	template <typename U, typename T>
 	void copy_whole_attribute_array(gsl::span<T> dst, gsl::span<const gsl::byte> src_ptr, u8 attribute_size, u8 dst_stride, u32 src_stride, u32 vertex_count)
 	{
@@ -55,6 +130,13 @@ void write_vertex_array_data_to_buffer(gsl::span<gsl::byte> raw_dst_span, gsl::s
 	case rsx::vertex_base_type::ub:
 	case rsx::vertex_base_type::ub256:
 	{
+		if (attribute_src_stride == vector_element_count && dst_stride == vector_element_count)
+		{
+			verify(HERE), raw_dst_span.size_bytes() >= count * dst_stride, src_ptr.size_bytes() >= count * attribute_src_stride;
+			std::memcpy(raw_dst_span.data(), src_ptr.data(), count * vector_element_count);
+			return;
+		}
+
 		gsl::span<u8> dst_span = as_span_workaround<u8>(raw_dst_span);
 		copy_whole_attribute_array<u8>(dst_span, src_ptr, vector_element_count, dst_stride, attribute_src_stride, count);
 		return;
@@ -63,12 +145,22 @@ void write_vertex_array_data_to_buffer(gsl::span<gsl::byte> raw_dst_span, gsl::s
 	case rsx::vertex_base_type::sf:
 	case rsx::vertex_base_type::s32k:
 	{
+		if (copy_attribute_array_fast<u16>(raw_dst_span, src_ptr, vector_element_count, dst_stride, attribute_src_stride, count))
+		{
+			return;
+		}
+
 		gsl::span<u16> dst_span = as_span_workaround<u16>(raw_dst_span);
 		copy_whole_attribute_array<be_t<u16>>(dst_span, src_ptr, vector_element_count, dst_stride, attribute_src_stride, count);
 		return;
 	}
 	case rsx::vertex_base_type::f:
 	{
+		if (copy_attribute_array_fast<u32>(raw_dst_span, src_ptr, vector_element_count, dst_stride, attribute_src_stride, count))
+		{
+			return;
+		}
+
 		gsl::span<u32> dst_span = as_span_workaround<u32>(raw_dst_span);
 		copy_whole_attribute_array<be_t<u32>>(dst_span, src_ptr, vector_element_count, dst_stride, attribute_src_stride, count);
 		return;
@@ -95,17 +187,125 @@ void write_vertex_array_data_to_buffer(gsl::span<gsl::byte> raw_dst_span, gsl::s
 
 namespace
 {
+// SSE2 helpers for unsigned index comparison (values are biased to make signed comparison work)
+template<typename T>
+struct index_sse;
+
+template<>
+struct index_sse<u16>
+{
+	static inline __m128i set1(u16 value)
+	{
+		return _mm_set1_epi16(value);
+	}
+
+	static inline __m128i bias()
+	{
+		return _mm_set1_epi16(0x8000);
+	}
+
+	static inline __m128i cmpeq(__m128i a, __m128i b)
+	{
+		return _mm_cmpeq_epi16(a, b);
+	}
+
+	static inline __m128i min(__m128i a, __m128i b)
+	{
+		return _mm_min_epi16(a, b);
+	}
+
+	static inline __m128i max(__m128i a, __m128i b)
+	{
+		return _mm_max_epi16(a, b);
+	}
+};
+
+template<>
+struct index_sse<u32>
+{
+	static inline __m128i set1(u32 value)
+	{
+		return _mm_set1_epi32(value);
+	}
+
+	static inline __m128i bias()
+	{
+		return _mm_set1_epi32(0x80000000);
+	}
+
+	static inline __m128i cmpeq(__m128i a, __m128i b)
+	{
+		return _mm_cmpeq_epi32(a, b);
+	}
+
+	static inline __m128i min(__m128i a, __m128i b)
+	{
+		const __m128i gt = _mm_cmpgt_epi32(a, b);
+		return _mm_or_si128(_mm_and_si128(gt, b), _mm_andnot_si128(gt, a));
+	}
+
+	static inline __m128i max(__m128i a, __m128i b)
+	{
+		const __m128i gt = _mm_cmpgt_epi32(a, b);
+		return _mm_or_si128(_mm_and_si128(gt, a), _mm_andnot_si128(gt, b));
+	}
+};
+
 template<typename T>
 std::tuple<T, T> upload_untouched(gsl::span<to_be_t<const T>> src, gsl::span<T> dst, bool is_primitive_restart_enabled, T primitive_restart_index)
 {
+	using sse = index_sse<T>;
+
 	T min_index = -1;
 	T max_index = 0;
 
 	verify(HERE), (dst.size_bytes() >= src.size_bytes());
 
-	size_t dst_idx = 0;
-	for (T index : src)
+	const size_t count = src.size();
+	const auto src_ptr = reinterpret_cast<const u8*>(src.data());
+	const auto dst_ptr = reinterpret_cast<u8*>(dst.data());
+
+	// Process 16 bytes at once: byteswap, replace restart index with -1, compute min/max ignoring restart index
+	const __m128i mask = get_bswap_mask<T>();
+	const __m128i bias = sse::bias();
+	const __m128i restart = sse::set1(primitive_restart_index);
+	__m128i vmin = _mm_xor_si128(sse::set1(min_index), bias);
+	__m128i vmax = _mm_xor_si128(sse::set1(max_index), bias);
+
+	size_t i = 0;
+
+	for (; i + 16 / sizeof(T) <= count; i += 16 / sizeof(T))
 	{
+		__m128i value = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src_ptr + i * sizeof(T))), mask);
+		__m128i value_max = value;
+
+		if (is_primitive_restart_enabled)
+		{
+			const __m128i cut = sse::cmpeq(value, restart);
+			value = _mm_or_si128(value, cut);
+			value_max = _mm_andnot_si128(cut, value);
+		}
+
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst_ptr + i * sizeof(T)), value);
+		vmin = sse::min(vmin, _mm_xor_si128(value, bias));
+		vmax = sse::max(vmax, _mm_xor_si128(value_max, bias));
+	}
+
+	alignas(16) T lanes_min[16 / sizeof(T)];
+	alignas(16) T lanes_max[16 / sizeof(T)];
+	_mm_store_si128(reinterpret_cast<__m128i*>(lanes_min), _mm_xor_si128(vmin, bias));
+	_mm_store_si128(reinterpret_cast<__m128i*>(lanes_max), _mm_xor_si128(vmax, bias));
+
+	for (u32 j = 0; j < 16 / sizeof(T); j++)
+	{
+		min_index = std::min(min_index, lanes_min[j]);
+		max_index = std::max(max_index, lanes_max[j]);
+	}
+
+	for (; i < count; i++)
+	{
+		T index = src[i];
+
 		if (is_primitive_restart_enabled && index == primitive_restart_index)
 		{
 			index = -1;
@@ -115,7 +315,7 @@ std::tuple<T, T> upload_untouched(gsl::span<to_be_t<const T>> src, gsl::span<T>
 			max_index = std::max(max_index, index);
 			min_index = std::min(min_index, index);
 		}
-		dst[dst_idx++] = index;
+		dst[i] = index;
 	}
 	return std::make_tuple(min_index, max_index);
 }
@@ -74,6 +74,31 @@ size_t fragment_program_utils::get_fragment_program_ucode_size(void *ptr)
 	}
 }
 
+size_t fragment_program_utils::get_fragment_program_ucode_size(const void *ptr, size_t max_size)
+{
+	const qword *instBuffer = (const qword*)ptr;
+	size_t instIndex = 0;
+	while ((instIndex + 1) * 16 <= max_size)
+	{
+		const qword& inst = instBuffer[instIndex];
+		bool end = (inst.word[0] >> 8) & 0x1;
+
+		if (is_constant(inst.word[1]) || is_constant(inst.word[2]) || is_constant(inst.word[3]))
+		{
+			instIndex += 2;
+		}
+		else
+		{
+			instIndex++;
+		}
+
+		if (end)
+			return instIndex * 16 <= max_size ? instIndex * 16 : 0;
+	}
+
+	return 0;
+}
+
 size_t fragment_program_hash::operator()(const RSXFragmentProgram& program) const
 {
 	// 64-bit Fowler/Noll/Vo FNV-1a hash code
@@ -41,6 +41,11 @@ namespace program_hash_util
 		static bool is_constant(u32 sourceOperand);
 
 		static size_t get_fragment_program_ucode_size(void *ptr);
+
+		/**
+		* returns ucode size or 0 if the end of the program is not found within max_size bytes
+		*/
+		static size_t get_fragment_program_ucode_size(const void *ptr, size_t max_size);
 	};
 
 	struct fragment_program_hash
@@ -52,6 +57,38 @@ namespace program_hash_util
 	{
 		bool operator()(const RSXFragmentProgram &binary1, const RSXFragmentProgram &binary2) const;
 	};
+
+	// Combine 64-bit hash values (boost::hash_combine mixing with murmur3 finalizer)
+	inline u64 hash_combine(u64 seed, u64 value)
+	{
+		seed ^= value + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2);
+		seed ^= seed >> 33;
+		seed *= 0xff51afd7ed558ccdull;
+		seed ^= seed >> 33;
+		return seed;
+	}
+
+	// Backend traits may set persistent_pipeline_properties if pipeline_properties can be stored as raw bytes
+	template <typename T, typename = void>
+	struct has_persistent_properties : std::false_type
+	{
+	};
+
+	template <typename T>
+	struct has_persistent_properties<T, std::enable_if_t<T::persistent_pipeline_properties>> : std::true_type
+	{
+	};
+
+	// Shader cache file header
+	struct cache_header
+	{
+		char magic[4];
+		u32 version;
+		u32 vp_count;
+		u32 fp_count;
+		u32 pipeline_count;
+		u32 properties_size;
+	};
 }
 
 
@@ -68,6 +105,7 @@ namespace program_hash_util
 * - static void recompile_fragment_program(RSXFragmentProgram *RSXFP, FragmentProgramData& fragmentProgramData, size_t ID);
 * - static void recompile_vertex_program(RSXVertexProgram *RSXVP, VertexProgramData& vertexProgramData, size_t ID);
 * - static PipelineData build_program(VertexProgramData &vertexProgramData, FragmentProgramData &fragmentProgramData, const PipelineProperties &pipelineProperties, const ExtraData& extraData);
+* Optionally, static const bool persistent_pipeline_properties = true allows saving pipelines in the shader cache file.
 */
 template<typename backend_traits>
 class program_state_cache
@@ -80,6 +118,9 @@ class program_state_cache
 	using binary_to_vertex_program = std::unordered_map<RSXVertexProgram, vertex_program_type, program_hash_util::vertex_program_hash, program_hash_util::vertex_program_compare> ;
 	using binary_to_fragment_program = std::unordered_map<RSXFragmentProgram, fragment_program_type, program_hash_util::fragment_program_hash, program_hash_util::fragment_program_compare>;
 
+	using binary_to_vertex_program_index = std::unordered_map<RSXVertexProgram, u32, program_hash_util::vertex_program_hash, program_hash_util::vertex_program_compare>;
+	using binary_to_fragment_program_index = std::unordered_map<RSXFragmentProgram, u32, program_hash_util::fragment_program_hash, program_hash_util::fragment_program_compare>;
+
 
 	struct pipeline_key
 	{
@@ -92,11 +133,9 @@ class program_state_cache
 	{
 		size_t operator()(const pipeline_key &key) const
 		{
-			size_t hashValue = 0;
-			hashValue ^= std::hash<unsigned>()(key.vertex_program_id);
-			hashValue ^= std::hash<unsigned>()(key.fragment_program_id);
-			hashValue ^= std::hash<pipeline_properties>()(key.properties);
-			return hashValue;
+			u64 hash = u64{key.vertex_program_id} << 32 | key.fragment_program_id;
+			hash = program_hash_util::hash_combine(hash, std::hash<pipeline_properties>()(key.properties));
+			return static_cast<size_t>(hash);
 		}
 	};
 
@@ -108,21 +147,76 @@ class program_state_cache
 		}
 	};
 
+public:
+	// Shader cache file format version (increment when decompilers change)
+	static const u32 cache_version = 1;
+
+	struct stats
+	{
+		u64 vp_hits;
+		u64 vp_misses;
+		u64 fp_hits;
+		u64 fp_misses;
+		u64 pipeline_hits;
+		u64 pipeline_misses;
+		u64 prewarmed; // Programs and pipelines compiled from the cache file
+	};
+
 protected:
+	// Pipeline loaded from the cache file (indices of loaded programs)
+	struct loaded_pipeline
+	{
+		u32 vp_index;
+		u32 fp_index;
+		pipeline_properties properties;
+	};
+
 	size_t m_next_id = 0;
 	binary_to_vertex_program m_vertex_shader_cache;
 	binary_to_fragment_program m_fragment_shader_cache;
 	std::unordered_map <pipeline_key, pipeline_storage_type, pipeline_key_hash, pipeline_key_compare> m_storage;
 
+	stats m_stats{};
+
+	// Shader cache file (empty if disabled)
+	std::string m_cache_path;
+
+	// New programs were compiled since loading the cache file
+	bool m_cache_dirty = false;
+
+	// Contents of the cache file (fragment programs own their ucode copies until prewarming ends)
+	std::vector<RSXVertexProgram> m_loaded_vp;
+	std::vector<RSXFragmentProgram> m_loaded_fp;
+	std::vector<loaded_pipeline> m_loaded_pipelines;
+
+	// Prewarming position (vertex programs, then fragment programs, then pipelines)
+	size_t m_prewarm_pos = 0;
+
+	void free_loaded()
+	{
+		for (auto& fp : m_loaded_fp)
+		{
+			free(fp.addr);
+		}
+
+		m_loaded_vp.clear();
+		m_loaded_fp.clear();
+		m_loaded_pipelines.clear();
+		m_prewarm_pos = 0;
+	}
+
 	/// bool here to inform that the program was preexisting.
 	std::tuple<const vertex_program_type&, bool> search_vertex_program(const RSXVertexProgram& rsx_vp)
 	{
 		const auto& I = m_vertex_shader_cache.find(rsx_vp);
 		if (I != m_vertex_shader_cache.end())
 		{
+			m_stats.vp_hits++;
 			return std::forward_as_tuple(I->second, true);
 		}
 		LOG_NOTICE(RSX, "VP not found in buffer!");
+		m_stats.vp_misses++;
+		m_cache_dirty = true;
 		vertex_program_type& new_shader = m_vertex_shader_cache[rsx_vp];
 		backend_traits::recompile_vertex_program(rsx_vp, new_shader, m_next_id++);
 
@@ -135,9 +229,12 @@ protected:
 		const auto& I = m_fragment_shader_cache.find(rsx_fp);
 		if (I != m_fragment_shader_cache.end())
 		{
+			m_stats.fp_hits++;
 			return std::forward_as_tuple(I->second, true);
 		}
 		LOG_NOTICE(RSX, "FP not found in buffer!");
+		m_stats.fp_misses++;
+		m_cache_dirty = true;
 		size_t fragment_program_size = program_hash_util::fragment_program_utils::get_fragment_program_ucode_size(rsx_fp.addr);
 		gsl::not_null<void*> fragment_program_ucode_copy = malloc(fragment_program_size);
 		std::memcpy(fragment_program_ucode_copy, rsx_fp.addr, fragment_program_size);
@@ -153,6 +250,8 @@ public:
 	program_state_cache() = default;
 	~program_state_cache()
 	{
+		free_loaded();
+
 		for (auto& pair : m_fragment_shader_cache)
 		{
 			free(pair.first.addr);
@@ -197,9 +296,15 @@ public:
 		{
 			const auto I = m_storage.find(key);
 			if (I != m_storage.end())
+			{
+				m_stats.pipeline_hits++;
 				return I->second;
+			}
 		}
 
+		m_stats.pipeline_misses++;
+		m_cache_dirty = true;
+
 		LOG_NOTICE(RSX, "Add program :");
 		LOG_NOTICE(RSX, "*** vp id = %d", vertex_program.id);
 		LOG_NOTICE(RSX, "*** fp id = %d", fragment_program.id);
@@ -244,4 +349,262 @@ public:
 	{
 		m_storage.clear();
 	}
+
+	stats get_stats() const
+	{
+		return m_stats;
+	}
+
+	// Read shader cache file, programs are compiled later by prewarm()
+	void load_cache(const std::string& path)
+	{
+		free_loaded();
+		m_cache_path = path;
+
+		const fs::file file(path);
+
+		if (!file)
+		{
+			return;
+		}
+
+		program_hash_util::cache_header header;
+
+		if (!file.read(header) || std::memcmp(header.magic, "RSXC", 4) != 0 || header.version != cache_version || header.properties_size != sizeof(pipeline_properties))
+		{
+			LOG_WARNING(RSX, "Shader cache is outdated or corrupted: %s", path);
+			return;
+		}
+
+		const auto fail = [&]()
+		{
+			LOG_ERROR(RSX, "Shader cache is corrupted: %s", path);
+			free_loaded();
+		};
+
+		// RSX program limits: 512 vertex program instructions, 16 vertex inputs, 64K of fragment program ucode
+		const u32 max_vp_size = 512 * 4;
+		const u32 max_vp_inputs = 16;
+		const u32 max_fp_size = 0x10000;
+
+		for (u32 i = 0; i < header.vp_count; i++)
+		{
+			RSXVertexProgram vp;
+			u32 sizes[2];
+
+			if (!file.read(vp.output_mask) || !file.read(sizes) || sizes[0] > max_vp_size || sizes[1] > max_vp_inputs ||
+				sizes[0] * sizeof(u32) + sizes[1] * sizeof(rsx_vertex_input) > file.size() - file.pos())
+			{
+				return fail();
+			}
+
+			if (!file.read(vp.data, sizes[0]) || !file.read(vp.rsx_vertex_inputs, sizes[1]) || vp.data.size() % 4)
+			{
+				return fail();
+			}
+
+			m_loaded_vp.emplace_back(std::move(vp));
+		}
+
+		for (u32 i = 0; i < header.fp_count; i++)
+		{
+			RSXFragmentProgram fp;
+			u32 size;
+
+			if (file.read(&fp, sizeof(fp)) != sizeof(fp) || !file.read(size) || size > max_fp_size || size > file.size() - file.pos())
+			{
+				return fail();
+			}
+
+			fp.addr = malloc(size);
+
+			if (!fp.addr || file.read(fp.addr, size) != size || program_hash_util::fragment_program_utils::get_fragment_program_ucode_size(fp.addr, size) != size)
+			{
+				free(fp.addr);
+				return fail();
+			}
+
+			m_loaded_fp.emplace_back(fp);
+		}
+
+		for (u32 i = 0; i < header.pipeline_count; i++)
+		{
+			loaded_pipeline pipeline;
+
+			if (!file.read(pipeline.vp_index) || !file.read(pipeline.fp_index) || file.read(&pipeline.properties, sizeof(pipeline_properties)) != sizeof(pipeline_properties) ||
+				pipeline.vp_index >= m_loaded_vp.size() || pipeline.fp_index >= m_loaded_fp.size())
+			{
+				return fail();
+			}
+
+			m_loaded_pipelines.emplace_back(pipeline);
+		}
+
+		LOG_NOTICE(RSX, "Shader cache loaded: %u vertex programs, %u fragment programs, %u pipelines", m_loaded_vp.size(), m_loaded_fp.size(), m_loaded_pipelines.size());
+	}
+
+	// Compile up to count entries loaded from the shader cache file, returns true if more entries are pending
+	template<typename... Args>
+	bool prewarm(u32 count, Args&& ...args)
+	{
+		const size_t total = m_loaded_vp.size() + m_loaded_fp.size() + m_loaded_pipelines.size();
+
+		if (m_prewarm_pos >= total)
+		{
+			return false;
+		}
+
+		// Prewarming must not affect statistics
+		const auto saved_stats = m_stats;
+		const bool saved_dirty = m_cache_dirty;
+		const size_t start = m_prewarm_pos;
+
+		for (; count && m_prewarm_pos < total; count--, m_prewarm_pos++)
+		{
+			size_t pos = m_prewarm_pos;
+
+			if (pos < m_loaded_vp.size())
+			{
+				search_vertex_program(m_loaded_vp[pos]);
+			}
+			else if ((pos -= m_loaded_vp.size()) < m_loaded_fp.size())
+			{
+				search_fragment_program(m_loaded_fp[pos]);
+			}
+			else
+			{
+				const auto& pipeline = m_loaded_pipelines[pos - m_loaded_fp.size()];
+				getGraphicPipelineState(m_loaded_vp[pipeline.vp_index], m_loaded_fp[pipeline.fp_index], pipeline.properties, std::forward<Args>(args)...);
+			}
+		}
+
+		m_stats = saved_stats;
+		m_stats.prewarmed += m_prewarm_pos - start;
+		m_cache_dirty = saved_dirty;
+
+		if (m_prewarm_pos < total)
+		{
+			return true;
+		}
+
+		LOG_SUCCESS(RSX, "Shader cache: %u entries compiled", total);
+
+		// Loaded entries are no longer needed
+		free_loaded();
+		return false;
+	}
+
+	// Write shader cache file (programs loaded but not compiled yet are preserved)
+	void save_cache()
+	{
+		if (m_cache_path.empty() || !m_cache_dirty)
+		{
+			return;
+		}
+
+		binary_to_vertex_program_index vp_index;
+		binary_to_fragment_program_index fp_index;
+		std::vector<const RSXVertexProgram*> vps;
+		std::vector<const RSXFragmentProgram*> fps;
+		std::vector<std::tuple<u32, u32, const pipeline_properties*>> pipelines;
+
+		const auto add_vp = [&](const RSXVertexProgram& vp)
+		{
+			const auto result = vp_index.emplace(vp, ::size32(vps));
+			if (result.second) vps.emplace_back(&result.first->first);
+			return result.first->second;
+		};
+
+		const auto add_fp = [&](const RSXFragmentProgram& fp)
+		{
+			const auto result = fp_index.emplace(fp, ::size32(fps));
+			if (result.second) fps.emplace_back(&result.first->first);
+			return result.first->second;
+		};
+
+		// Map backend program ids to their keys
+		std::unordered_map<u32, u32> vp_ids, fp_ids;
+
+		for (const auto& pair : m_vertex_shader_cache)
+		{
+			vp_ids.emplace(pair.second.id, add_vp(pair.first));
+		}
+
+		for (const auto& pair : m_fragment_shader_cache)
+		{
+			fp_ids.emplace(pair.second.id, add_fp(pair.first));
+		}
+
+		if (program_hash_util::has_persistent_properties<backend_traits>::value)
+		{
+			for (const auto& pair : m_storage)
+			{
+				const auto vp = vp_ids.find(pair.first.vertex_program_id);
+				const auto fp = fp_ids.find(pair.first.fragment_program_id);
+
+				if (vp != vp_ids.end() && fp != fp_ids.end())
+				{
+					pipelines.emplace_back(vp->second, fp->second, &pair.first.properties);
+				}
+			}
+		}
+
+		// Pending entries (prewarming is incomplete)
+		for (size_t i = std::max(m_prewarm_pos, m_loaded_vp.size()) - m_loaded_vp.size(); i < m_loaded_fp.size(); i++)
+		{
+			add_fp(m_loaded_fp[i]);
+		}
+
+		for (size_t i = m_prewarm_pos; i < m_loaded_vp.size(); i++)
+		{
+			add_vp(m_loaded_vp[i]);
+		}
+
+		const size_t pipeline_start = m_loaded_vp.size() + m_loaded_fp.size();
+
+		for (size_t i = std::max(m_prewarm_pos, pipeline_start) - pipeline_start; i < m_loaded_pipelines.size(); i++)
+		{
+			const auto& pipeline = m_loaded_pipelines[i];
+			pipelines.emplace_back(add_vp(m_loaded_vp[pipeline.vp_index]), add_fp(m_loaded_fp[pipeline.fp_index]), &pipeline.properties);
+		}
+
+		fs::file file(m_cache_path, fs::rewrite);
+
+		if (!file)
+		{
+			LOG_ERROR(RSX, "Failed to write shader cache: %s", m_cache_path);
+			return;
+		}
+
+		program_hash_util::cache_header header{{'R', 'S', 'X', 'C'}, cache_version, ::size32(vps), ::size32(fps), ::size32(pipelines), sizeof(pipeline_properties)};
+		file.write(header);
+
+		for (const auto vp : vps)
+		{
+			const u32 sizes[2]{::size32(vp->data), ::size32(vp->rsx_vertex_inputs)};
+			file.write(vp->output_mask);
+			file.write(sizes);
+			file.write(vp->data);
+			file.write(vp->rsx_vertex_inputs);
+		}
+
+		for (const auto fp : fps)
+		{
+			const u32 size = ::narrow<u32>(program_hash_util::fragment_program_utils::get_fragment_program_ucode_size(fp->addr));
+			file.write(fp, sizeof(*fp));
+			file.write(size);
+			file.write(fp->addr, size);
+		}
+
+		for (const auto& pipeline : pipelines)
+		{
+			file.write(std::get<0>(pipeline));
+			file.write(std::get<1>(pipeline));
+			file.write(std::get<2>(pipeline), sizeof(pipeline_properties));
+		}
+
+		m_cache_dirty = false;
+
+		LOG_NOTICE(RSX, "Shader cache saved: %u vertex programs, %u fragment programs, %u pipelines", vps.size(), fps.size(), pipelines.size());
+	}
 };
@@ -0,0 +1,321 @@
+#include "stdafx.h"
+#include "Utilities/Thread.h"
+#include "software_blit.h"
+
+#include <thread>
+
+extern "C"
+{
+#include "libswscale/swscale.h"
+}
+
+namespace
+{
+	// Rows processed by a single task
+	constexpr u32 blit_band_rows = 16;
+
+	// Minimal amount of pixels for splitting the work between workers
+	constexpr u32 blit_parallel_threshold = 256 * 256;
+
+	// Maximal amount of cached swscale contexts
+	constexpr std::size_t blit_sws_cache_size = 32;
+
+	using rsx::blit_sample;
+
+	// Pixel centers are matched
+	void get_samples(std::vector<blit_sample>& out, u32 src_size, u32 dst_size, u32 src_limit, bool bilinear)
+	{
+		out.resize(dst_size);
+
+		for (u32 i = 0; i < dst_size; i++)
+		{
+			auto& s = out[i];
+
+			if (bilinear)
+			{
+				// Center of the destination pixel in the source (16.16 fixed point)
+				const s64 pos = std::max<s64>(s64(((2 * i + 1) * (u64{src_size} << 16)) / (2 * dst_size)) - 0x8000, 0);
+
+				s.index0 = std::min<u32>(u32(pos >> 16), src_limit - 1);
+				s.index1 = std::min<u32>(s.index0 + 1, src_limit - 1);
+				s.weight = u32(pos >> 8) & 0xff;
+			}
+			else
+			{
+				s.index0 = std::min<u32>(u32(((2 * i + 1) * u64{src_size}) / (2 * dst_size)), src_limit - 1);
+				s.index1 = s.index0;
+				s.weight = 0;
+			}
+		}
+	}
+
+	template<typename T>
+	void blit_nearest_rows(u8* dst, u32 dst_pitch, const u8* src, u32 src_pitch, const blit_sample* xs, u32 width, const blit_sample* ys, u32 first, u32 last)
+	{
+		for (u32 y = first; y < last; y++)
+		{
+			T* out = reinterpret_cast<T*>(dst + y * dst_pitch);
+			const T* in = reinterpret_cast<const T*>(src + ys[y].index0 * src_pitch);
+
+			for (u32 x = 0; x < width; x++)
+			{
+				out[x] = in[xs[x].index0];
+			}
+		}
+	}
+
+	// Interpolates every byte of 32-bit pixels independently
+	void blit_bilinear_rows_32(u8* dst, u32 dst_pitch, const u8* src, u32 src_pitch, const blit_sample* xs, u32 width, const blit_sample* ys, u32 first, u32 last)
+	{
+		for (u32 y = first; y < last; y++)
+		{
+			u8* out = dst + y * dst_pitch;
+			const u8* in0 = src + ys[y].index0 * src_pitch;
+			const u8* in1 = src + ys[y].index1 * src_pitch;
+			const u32 wy = ys[y].weight;
+
+			for (u32 x = 0; x < width; x++, out += 4)
+			{
+				const u32 x0 = xs[x].index0 * 4;
+				const u32 x1 = xs[x].index1 * 4;
+				const u32 wx = xs[x].weight;
+
+				for (u32 c = 0; c < 4; c++)
+				{
+					const u32 top = in0[x0 + c] * (256 - wx) + in0[x1 + c] * wx;
+					const u32 bottom = in1[x0 + c] * (256 - wx) + in1[x1 + c] * wx;
+					out[c] = static_cast<u8>((top * (256 - wy) + bottom * wy + 0x8000) >> 16);
+				}
+			}
+		}
+	}
+}
+
+namespace rsx
+{
+	software_blitter::~software_blitter()
+	{
+		m_stop = true;
+
+		for (auto& worker : m_workers)
+		{
+			worker->notify();
+			worker->join();
+		}
+
+		for (auto& pair : m_sws_cache)
+		{
+			sws_freeContext(pair.second);
+		}
+	}
+
+	void software_blitter::start_workers()
+	{
+		// The calling thread takes a share of the work as well
+		const u32 count = std::min<u32>(std::thread::hardware_concurrency(), 4);
+
+		for (u32 i = 1; i < count; i++)
+		{
+			m_workers.emplace_back();
+
+			thread_ctrl::spawn(m_workers.back(), fmt::format("RSX Blit Worker %u", i), [this]()
+			{
+				std::shared_ptr<job> last;
+
+				while (!m_stop)
+				{
+					std::shared_ptr<job> current;
+					{
+						std::lock_guard<std::mutex> lock(m_mutex);
+						current = m_job;
+					}
+
+					if (current && current != last)
+					{
+						process(*current);
+						last = std::move(current);
+						continue;
+					}
+
+					thread_ctrl::wait();
+				}
+			});
+		}
+	}
+
+	void software_blitter::process(job& job)
+	{
+		for (u32 band; (band = job.next++) < job.count;)
+		{
+			job.func(band);
+
+			if (++job.done == job.count && job.owner != thread_ctrl::get_current())
+			{
+				job.owner->notify();
+			}
+		}
+	}
+
+	void software_blitter::run(u32 count, std::function<void(u32 band)> func)
+	{
+		if (!m_workers_started)
+		{
+			m_workers_started = true;
+			start_workers();
+		}
+
+		const auto owner = thread_ctrl::get_current();
+
+		if (m_workers.empty() || count < 2 || !owner)
+		{
+			for (u32 band = 0; band < count; band++)
+			{
+				func(band);
+			}
+
+			return;
+		}
+
+		const auto current = std::make_shared<job>();
+		current->func = std::move(func);
+		current->count = count;
+		current->owner = owner;
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_job = current;
+		}
+
+		for (auto& worker : m_workers)
+		{
+			worker->notify();
+		}
+
+		process(*current);
+
+		// Wait for the bands taken by workers
+		thread_ctrl::wait([&] { return current->done.load() >= count; });
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_job.reset();
+	}
+
+	SwsContext* software_blitter::get_sws_context(const sws_key& key)
+	{
+		const auto found = m_sws_cache.find(key);
+
+		if (found != m_sws_cache.end())
+		{
+			return found->second;
+		}
+
+		if (m_sws_cache.size() >= blit_sws_cache_size)
+		{
+			for (auto& pair : m_sws_cache)
+			{
+				sws_freeContext(pair.second);
+			}
+
+			m_sws_cache.clear();
+		}
+
+		SwsContext* sws = sws_getContext(key.src_w, key.src_h, key.src_format, key.dst_w, key.dst_h, key.dst_format, key.flags, NULL, NULL, NULL);
+
+		if (!sws)
+		{
+			LOG_ERROR(RSX, "Blit: sws_getContext() failed (%ux%u -> %ux%u)", key.src_w, key.src_h, key.dst_w, key.dst_h);
+			return nullptr;
+		}
+
+		m_sws_cache.emplace(key, sws);
+		return sws;
+	}
+
+	u8* software_blitter::get_scratch(u32 index, u32 size)
+	{
+		auto& buffer = m_scratch[index];
+
+		if (buffer.size() < size)
+		{
+			buffer.resize(size);
+		}
+
+		return buffer.data();
+	}
+
+	void software_blitter::scale_image(u8* dst, AVPixelFormat dst_format, u32 dst_width, u32 dst_height, u32 dst_pitch,
+		const u8* src, AVPixelFormat src_format, u32 src_width, u32 src_height, u32 src_pitch, u32 src_slice_h, bool bilinear)
+	{
+		const u32 slice_h = std::min<u32>(src_slice_h, src_height);
+
+		if (!dst_width || !dst_height || !src_width || !slice_h)
+		{
+			return;
+		}
+
+		const u32 bpp = src_format == AV_PIX_FMT_ARGB ? 4 : src_format == AV_PIX_FMT_RGB565BE ? 2 : 0;
+
+		if (src_format != dst_format || !bpp || (bilinear && bpp != 4))
+		{
+			// Format conversion or unsupported format: fall back to swscale
+			if (SwsContext* sws = get_sws_context({src_width, src_height, dst_width, dst_height, src_format, dst_format, bilinear ? SWS_FAST_BILINEAR : SWS_POINT}))
+			{
+				const int src_stride = src_pitch;
+				const int dst_stride = dst_pitch;
+				sws_scale(sws, &src, &src_stride, 0, slice_h, &dst, &dst_stride);
+			}
+
+			return;
+		}
+
+		// Only the rows which can be produced from the source slice are written (like swscale)
+		const u32 rows = std::min<u32>(dst_height, (slice_h * dst_height + src_height - 1) / src_height);
+
+		get_samples(m_samples_x, src_width, dst_width, src_width, bilinear);
+		get_samples(m_samples_y, src_height, dst_height, slice_h, bilinear);
+
+		const blit_sample* xs = m_samples_x.data();
+		const blit_sample* ys = m_samples_y.data();
+
+		const auto func = [=](u32 band)
+		{
+			const u32 first = band * blit_band_rows;
+			const u32 last = std::min(first + blit_band_rows, rows);
+
+			if (bilinear)
+			{
+				blit_bilinear_rows_32(dst, dst_pitch, src, src_pitch, xs, dst_width, ys, first, last);
+			}
+			else if (bpp == 4)
+			{
+				blit_nearest_rows<u32>(dst, dst_pitch, src, src_pitch, xs, dst_width, ys, first, last);
+			}
+			else
+			{
+				blit_nearest_rows<u16>(dst, dst_pitch, src, src_pitch, xs, dst_width, ys, first, last);
+			}
+		};
+
+		const u32 bands = (rows + blit_band_rows - 1) / blit_band_rows;
+
+		if (dst_width * rows < blit_parallel_threshold)
+		{
+			for (u32 band = 0; band < bands; band++)
+			{
+				func(band);
+			}
+
+			return;
+		}
+
+		run(bands, func);
+	}
+
+	u8* software_blitter::scale_to_scratch(u32 scratch, AVPixelFormat dst_format, u32 dst_width, u32 dst_height, u32 dst_pitch,
+		const u8* src, AVPixelFormat src_format, u32 src_width, u32 src_height, u32 src_pitch, u32 src_slice_h, bool bilinear)
+	{
+		u8* dst = get_scratch(scratch, dst_pitch * dst_height);
+		scale_image(dst, dst_format, dst_width, dst_height, dst_pitch, src, src_format, src_width, src_height, src_pitch, src_slice_h, bilinear);
+		return dst;
+	}
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "Utilities/Atomic.h"
+#include <functional>
+#include <mutex>
+#include <map>
+#include <tuple>
+
+extern "C"
+{
+#include <libavutil/pixfmt.h>
+}
+
+struct SwsContext;
+class thread_ctrl;
+
+namespace rsx
+{
+	// Source sampling position of the destination coordinate
+	struct blit_sample
+	{
+		u32 index0;
+		u32 index1;
+		u32 weight; // weight of index1 (0..256)
+	};
+
+	/**
+	* Software implementation of the scaled/converted image copies issued by NV3089.
+	* Holds reusable scratch buffers, a small cache of swscale contexts and a pool of workers.
+	* Same-format nearest/bilinear scaling is done without swscale and split in row bands.
+	* Only the thread issuing the blits (RSX thread) may use the scratch buffers.
+	*/
+	class software_blitter
+	{
+		struct job
+		{
+			std::function<void(u32 band)> func;
+			u32 count;
+			thread_ctrl* owner; // Notified when the last band is done
+			atomic_t<u32> next{0};
+			atomic_t<u32> done{0};
+		};
+
+		struct sws_key
+		{
+			u32 src_w, src_h, dst_w, dst_h;
+			AVPixelFormat src_format, dst_format;
+			int flags;
+
+			bool operator <(const sws_key& rhs) const
+			{
+				return std::tie(src_w, src_h, dst_w, dst_h, src_format, dst_format, flags) <
+					std::tie(rhs.src_w, rhs.src_h, rhs.dst_w, rhs.dst_h, rhs.src_format, rhs.dst_format, rhs.flags);
+			}
+		};
+
+		std::vector<u8> m_scratch[3];
+
+		std::vector<blit_sample> m_samples_x;
+		std::vector<blit_sample> m_samples_y;
+
+		std::map<sws_key, SwsContext*> m_sws_cache;
+
+		std::vector<std::shared_ptr<thread_ctrl>> m_workers;
+
+		std::mutex m_mutex;
+
+		// Current job (workers keep a reference to the last one they processed)
+		std::shared_ptr<job> m_job;
+
+		atomic_t<bool> m_stop{false};
+
+		bool m_workers_started = false;
+
+		void start_workers();
+
+		// Run func(band) for every band in [0, count), uses workers if available
+		void run(u32 count, std::function<void(u32 band)> func);
+
+		static void process(job& job);
+
+		SwsContext* get_sws_context(const sws_key& key);
+
+	public:
+		software_blitter() = default;
+
+		~software_blitter();
+
+		// Get scratch buffer of at least size bytes (contents aren't preserved)
+		u8* get_scratch(u32 index, u32 size);
+
+		// Scale and convert image (same semantics as convert_scale_image)
+		void scale_image(u8* dst, AVPixelFormat dst_format, u32 dst_width, u32 dst_height, u32 dst_pitch,
+			const u8* src, AVPixelFormat src_format, u32 src_width, u32 src_height, u32 src_pitch, u32 src_slice_h, bool bilinear);
+
+		// Scale and convert image into the scratch buffer
+		u8* scale_to_scratch(u32 scratch, AVPixelFormat dst_format, u32 dst_width, u32 dst_height, u32 dst_pitch,
+			const u8* src, AVPixelFormat src_format, u32 src_width, u32 src_height, u32 src_pitch, u32 src_slice_h, bool bilinear);
+	};
+}
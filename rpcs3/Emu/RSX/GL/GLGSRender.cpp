@@ -1,6 +1,7 @@
 #include "stdafx.h"
 #include "Utilities/Config.h"
 #include "Emu/Memory/Memory.h"
+#include "Emu/System.h"
 #include "GLGSRender.h"
 #include "GLVertexProgram.h"
 #include "../rsx_methods.h"
@@ -10,6 +11,7 @@
 extern cfg::bool_entry g_cfg_rsx_debug_output;
 extern cfg::bool_entry g_cfg_rsx_overlay;
 extern cfg::bool_entry g_cfg_rsx_gl_legacy_buffers;
+extern cfg::bool_entry g_cfg_rsx_shader_cache;
 
 #define DUMP_VERTEX_DATA 0
 
@@ -562,12 +564,18 @@ void GLGSRender::on_init_thread()
 		m_text_printer.init();
 
 	m_gl_texture_cache.initialize(this);
+
+	if (g_cfg_rsx_shader_cache)
+	{
+		m_prog_buffer.load_cache(Emu.GetCachePath() + "shaders_gl.bin");
+	}
 }
 
 void GLGSRender::on_exit()
 {
 	glDisable(GL_VERTEX_PROGRAM_POINT_SIZE);
 
+	m_prog_buffer.save_cache();
 	m_prog_buffer.clear();
 
 	if (draw_fbo)
@@ -881,8 +889,18 @@ void GLGSRender::flip(int buffer)
 		m_text_printer.print_text(0, 36, m_frame->client_width(), m_frame->client_height(), "vertex upload time: " + std::to_string(m_vertex_upload_time) + "us");
 		m_text_printer.print_text(0, 54, m_frame->client_width(), m_frame->client_height(), "textures upload time: " + std::to_string(m_textures_upload_time) + "us");
 		m_text_printer.print_text(0, 72, m_frame->client_width(), m_frame->client_height(), "draw call execution: " + std::to_string(m_draw_time) + "us");
+
+		const auto tex_stats = m_gl_texture_cache.get_stats();
+		m_text_printer.print_text(0, 90, m_frame->client_width(), m_frame->client_height(), "texture cache: " + std::to_string(tex_stats.hits) + " hits, " + std::to_string(tex_stats.misses) + " misses, " + std::to_string(tex_stats.invalidations) + " invalidations");
+
+		const auto prog_stats = m_prog_buffer.get_stats();
+		m_text_printer.print_text(0, 108, m_frame->client_width(), m_frame->client_height(), "shader cache: " + std::to_string(prog_stats.vp_hits + prog_stats.fp_hits) + " hits, " + std::to_string(prog_stats.vp_misses + prog_stats.fp_misses) + " misses, " +
+			std::to_string(prog_stats.pipeline_misses) + " pipelines built, " + std::to_string(prog_stats.prewarmed) + " prewarmed");
 	}
 
+	// Compile a few programs from the shader cache file every frame
+	m_prog_buffer.prewarm(16);
+
 	m_frame->flip(m_context);
 
 	m_draw_calls = 0;
@@ -10,6 +10,9 @@ struct GLTraits
 	using pipeline_storage_type = gl::glsl::program;
 	using pipeline_properties = void*;
 
+	// Pipeline properties are unused (always null)
+	static const bool persistent_pipeline_properties = true;
+
 	static
 	void recompile_fragment_program(const RSXFragmentProgram &RSXFP, fragment_program_type& fragmentProgramData, size_t ID)
 	{
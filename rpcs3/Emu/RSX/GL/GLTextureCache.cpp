@@ -19,31 +19,37 @@ namespace gl
 		{
 			std::lock_guard<std::mutex> lock(m_section_mutex);
 
-			for (cached_rtt_section &rtt : m_rtt_cache)
+			bool flushed = false;
+
+			m_rtt_index.for_each(address, 1, [&](u32 i)
 			{
-				if (rtt.is_dirty()) continue;
+				auto &rtt = m_rtt_cache[i];
+
+				if (rtt.is_dirty() || !rtt.is_locked())
+					return true;
 
-				if (rtt.is_locked() && rtt.overlaps(address))
+				if (rtt.is_flushed())
 				{
-					if (rtt.is_flushed())
-					{
-						LOG_WARNING(RSX, "Section matches range, but marked as already flushed!, 0x%X+0x%X", rtt.get_section_base(), rtt.get_section_size());
-						continue;
-					}
-
-					//LOG_WARNING(RSX, "Cell needs GPU data synced here, address=0x%X", address);
-
-					if (std::this_thread::get_id() != m_renderer_thread)
-					{
-						post_task = true;
-						section_to_post = &rtt;
-						break;
-					}
-
-					rtt.flush();
+					LOG_WARNING(RSX, "Section matches range, but marked as already flushed!, 0x%X+0x%X", rtt.get_section_base(), rtt.get_section_size());
 					return true;
 				}
-			}
+
+				//LOG_WARNING(RSX, "Cell needs GPU data synced here, address=0x%X", address);
+
+				if (std::this_thread::get_id() != m_renderer_thread)
+				{
+					post_task = true;
+					section_to_post = &rtt;
+					return false;
+				}
+
+				rtt.flush();
+				flushed = true;
+				return false;
+			});
+
+			if (flushed)
+				return true;
 		}
 
 		if (post_task)
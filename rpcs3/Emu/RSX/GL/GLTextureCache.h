@@ -424,26 +424,46 @@ namespace gl
 		std::pair<u32, u32> texture_cache_range = std::make_pair(0xFFFFFFFF, 0);
 		std::pair<u32, u32> rtt_cache_range = std::make_pair(0xFFFFFFFF, 0);
 
+		//Locked address ranges of the sections, indexed by position in m_texture_cache and m_rtt_cache
+		rsx::section_index m_texture_index;
+		rsx::section_index m_rtt_index;
+
+		//Statistics (reset with get_stats)
+		atomic_t<u32> m_cache_hits{ 0 };
+		atomic_t<u32> m_cache_misses{ 0 };
+		atomic_t<u32> m_invalidations{ 0 };
+
 		std::mutex m_section_mutex;
 
 		GLGSRender *m_renderer;
 		std::thread::id m_renderer_thread;
 
-		cached_texture_section *find_texture(u64 texaddr, u32 w, u32 h, u16 mipmaps)
+		cached_texture_section *find_texture(u32 texaddr, u32 w, u32 h, u16 mipmaps)
 		{
-			for (cached_texture_section &tex : m_texture_cache)
+			cached_texture_section *result = nullptr;
+
+			m_texture_index.for_each(texaddr, 1, [&](u32 i)
 			{
+				auto &tex = m_texture_cache[i];
+
 				if (tex.matches(texaddr, w, h, mipmaps) && !tex.is_dirty())
-					return &tex;
-			}
+				{
+					result = &tex;
+					return false;
+				}
+
+				return true;
+			});
 
-			return nullptr;
+			return result;
 		}
 
 		cached_texture_section& create_texture(u32 id, u32 texaddr, u32 texsize, u32 w, u32 h, u16 mipmap)
 		{
-			for (cached_texture_section &tex : m_texture_cache)
+			for (u32 i = 0; i < m_texture_cache.size(); ++i)
 			{
+				auto &tex = m_texture_cache[i];
+
 				if (tex.is_dirty())
 				{
 					tex.destroy();
@@ -451,6 +471,7 @@ namespace gl
 					tex.create(id, w, h, mipmap);
 					
 					texture_cache_range = tex.get_min_max(texture_cache_range);
+					m_texture_index.update(i, tex.get_locked_range());
 					return tex;
 				}
 			}
@@ -460,6 +481,7 @@ namespace gl
 			tex.create(id, w, h, mipmap);
 			texture_cache_range = tex.get_min_max(texture_cache_range);
 
+			m_texture_index.update(::size32(m_texture_cache), tex.get_locked_range());
 			m_texture_cache.push_back(tex);
 			return m_texture_cache.back();
 		}
@@ -479,20 +501,34 @@ namespace gl
 			m_rtt_cache.resize(0);
 			m_texture_cache.resize(0);
 
+			m_rtt_index.clear();
+			m_texture_index.clear();
+
 			clear_temporary_surfaces();
 		}
 
 		cached_rtt_section* find_cached_rtt_section(u32 base, u32 size)
 		{
-			for (cached_rtt_section &rtt : m_rtt_cache)
+			cached_rtt_section *result = nullptr;
+
+			m_rtt_index.for_each(base, 1, [&](u32 i)
 			{
-				if (rtt.matches(base, size))
+				if (m_rtt_cache[i].matches(base, size))
 				{
-					return &rtt;
+					result = &m_rtt_cache[i];
+					return false;
 				}
-			}
 
-			return nullptr;
+				return true;
+			});
+
+			return result;
+		}
+
+		//Update the index after the section has been reset
+		void update_rtt_index(cached_rtt_section *section)
+		{
+			m_rtt_index.update(::narrow<u32>(section - m_rtt_cache.data()), section->get_locked_range());
 		}
 
 		cached_rtt_section *create_locked_view_of_section(u32 base, u32 size)
@@ -524,6 +560,7 @@ namespace gl
 				}
 
 				rtt_cache_range = region->get_min_max(rtt_cache_range);
+				update_rtt_index(region);
 			}
 			else
 			{
@@ -532,6 +569,7 @@ namespace gl
 				{
 					region->unprotect();
 					region->reset(base, size);
+					update_rtt_index(region);
 				}
 
 				if (!region->is_locked() || region->is_flushed())
@@ -635,16 +673,18 @@ namespace gl
 
 				bool upload_from_cpu = false;
 
-				for (cached_rtt_section &section : m_rtt_cache)
+				m_rtt_index.for_each(texaddr, range, [&](u32 i)
 				{
-					if (section.overlaps(std::make_pair(texaddr, range)) && section.is_dirty())
+					if (m_rtt_cache[i].overlaps(std::make_pair(texaddr, range)) && m_rtt_cache[i].is_dirty())
 					{
 						LOG_ERROR(RSX, "Cell wrote to render target section we are uploading from!");
 
 						upload_from_cpu = true;
-						break;
+						return false;
 					}
-				}
+
+					return true;
+				});
 
 				if (!upload_from_cpu)
 				{
@@ -696,6 +736,7 @@ namespace gl
 			if (cached_texture)
 			{
 				verify(HERE), cached_texture->is_empty() == false;
+				m_cache_hits++;
 
 				gl_texture.set_id(cached_texture->id());
 				gl_texture.bind();
@@ -711,6 +752,7 @@ namespace gl
 				return;
 			}
 
+			m_cache_misses++;
 			gl_texture.init(index, tex);
 
 			std::lock_guard<std::mutex> lock(m_section_mutex);
@@ -761,6 +803,7 @@ namespace gl
 
 				region->reset(base, size);
 				region->protect(utils::protection::no);
+				update_rtt_index(region);
 			}
 
 			region->set_dimensions(width, height, pitch);
@@ -791,38 +834,40 @@ namespace gl
 		bool mark_as_dirty(u32 address)
 		{
 			bool response = false;
-			std::pair<u32, u32> trampled_range = std::make_pair(0xffffffff, 0x0);
+			std::pair<u32, u32> trampled_range = std::make_pair(address & ~4095, address + 4096);
 
-			//TODO: Optimize this function!
-			//Multi-pass checking is slow. Pre-calculate dependency tree at section creation
+			//Sections overlapping the trampled range are invalidated, which may extend the range to cover more sections.
+			//Invalidated sections are skipped, so the range is queried again until it stops growing.
 
 			if (address >= texture_cache_range.first &&
 				address < texture_cache_range.second)
 			{
 				std::lock_guard<std::mutex> lock(m_section_mutex);
 
-				for (int i = 0; i < m_texture_cache.size(); ++i)
+				while (true)
 				{
-					auto &tex = m_texture_cache[i];
-					if (!tex.is_locked()) continue;
+					const auto old_range = trampled_range;
 
-					auto overlapped = tex.overlaps_page(trampled_range, address);
-					if (std::get<0>(overlapped))
+					m_texture_index.for_each(old_range.first, old_range.second - old_range.first, [&](u32 i)
 					{
-						auto &new_range = std::get<1>(overlapped);
+						auto &tex = m_texture_cache[i];
 
-						if (new_range.first != trampled_range.first ||
-							new_range.second != trampled_range.second)
+						if (tex.is_locked())
 						{
-							trampled_range = new_range;
-							i = 0;
+							trampled_range = tex.get_min_max(trampled_range);
+
+							tex.unprotect();
+							tex.set_dirty(true);
+
+							m_invalidations++;
+							response = true;
 						}
 
-						tex.unprotect();
-						tex.set_dirty(true);
+						return true;
+					});
 
-						response = true;
-					}
+					if (trampled_range == old_range)
+						break;
 				}
 			}
 
@@ -831,28 +876,31 @@ namespace gl
 			{
 				std::lock_guard<std::mutex> lock(m_section_mutex);
 
-				for (int i = 0; i < m_rtt_cache.size(); ++i)
+				//The whole range trampled so far is checked against the render target sections
+				while (true)
 				{
-					auto &rtt = m_rtt_cache[i];
-					if (rtt.is_dirty() || !rtt.is_locked()) continue;
+					const auto old_range = trampled_range;
 
-					auto overlapped = rtt.overlaps_page(trampled_range, address);
-					if (std::get<0>(overlapped))
+					m_rtt_index.for_each(old_range.first, old_range.second - old_range.first, [&](u32 i)
 					{
-						auto &new_range = std::get<1>(overlapped);
+						auto &rtt = m_rtt_cache[i];
 
-						if (new_range.first != trampled_range.first ||
-							new_range.second != trampled_range.second)
+						if (!rtt.is_dirty() && rtt.is_locked())
 						{
-							trampled_range = new_range;
-							i = 0;
+							trampled_range = rtt.get_min_max(trampled_range);
+
+							rtt.unprotect();
+							rtt.set_dirty(true);
+
+							m_invalidations++;
+							response = true;
 						}
 
-						rtt.unprotect();
-						rtt.set_dirty(true);
+						return true;
+					});
 
-						response = true;
-					}
+					if (trampled_range == old_range)
+						break;
 				}
 			}
 
@@ -867,29 +915,54 @@ namespace gl
 			if (base < texture_cache_range.second &&
 				(base + size) >= texture_cache_range.first)
 			{
-				for (cached_texture_section &tex : m_texture_cache)
+				m_texture_index.for_each(base, size, [&](u32 i)
 				{
+					auto &tex = m_texture_cache[i];
+
 					if (!tex.is_dirty() && tex.overlaps(range))
+					{
 						tex.destroy();
-				}
+						m_invalidations++;
+					}
+
+					return true;
+				});
 			}
 
 			if (base < rtt_cache_range.second &&
 				(base + size) >= rtt_cache_range.first)
 			{
-				for (cached_rtt_section &rtt : m_rtt_cache)
+				m_rtt_index.for_each(base, size, [&](u32 i)
 				{
+					auto &rtt = m_rtt_cache[i];
+
 					if (!rtt.is_dirty() && rtt.overlaps(range))
 					{
 						rtt.unprotect();
 						rtt.set_dirty(true);
+						m_invalidations++;
 					}
-				}
+
+					return true;
+				});
 			}
 		}
 
 		bool flush_section(u32 address);
 
+		struct stats
+		{
+			u32 hits;
+			u32 misses;
+			u32 invalidations;
+		};
+
+		//Get texture lookup and invalidation counters since the last call
+		stats get_stats()
+		{
+			return{ m_cache_hits.exchange(0), m_cache_misses.exchange(0), m_invalidations.exchange(0) };
+		}
+
 		void clear_temporary_surfaces()
 		{
 			for (u32 &id : m_temporary_surfaces)
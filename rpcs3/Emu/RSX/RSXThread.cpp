@@ -24,6 +24,7 @@ cfg::bool_entry g_cfg_rsx_write_depth_buffer(cfg::root.video, "Write Depth Buffe
 cfg::bool_entry g_cfg_rsx_read_color_buffers(cfg::root.video, "Read Color Buffers");
 cfg::bool_entry g_cfg_rsx_read_depth_buffer(cfg::root.video, "Read Depth Buffer");
 cfg::bool_entry g_cfg_rsx_log_programs(cfg::root.video, "Log shader programs");
+cfg::bool_entry g_cfg_rsx_shader_cache(cfg::root.video, "Use Shader Cache", true);
 cfg::bool_entry g_cfg_rsx_vsync(cfg::root.video, "VSync");
 cfg::bool_entry g_cfg_rsx_debug_output(cfg::root.video, "Debug output");
 cfg::bool_entry g_cfg_rsx_overlay(cfg::root.video, "Debug overlay");
@@ -388,95 +389,262 @@ namespace rsx
 			}
 		});
 
+		m_fifo_ring.reset(new std::pair<u32, u32>[fifo_ring_size]);
+		m_fifo_ring_read = 0;
+		m_fifo_error = nullptr;
+		m_fifo_failed = false;
+
+		thread_ctrl::spawn(m_fifo_thread, "RSX FIFO Thread", [this]()
+		{
+			try
+			{
+				fifo_walk();
+			}
+			catch (...)
+			{
+				// Forward the error to the RSX thread
+				m_fifo_error = std::current_exception();
+				m_fifo_failed = true;
+				this->notify();
+			}
+		});
+
 		// TODO: exit condition
 		while (!Emu.IsStopped())
 		{
 			//Execute backend-local tasks first
 			do_local_task();
 
-			const u32 get = ctrl->get;
-			const u32 put = ctrl->put;
-
-			if (put == get || !Emu.IsRunning())
+			if (!m_fifo_batches.size() || !Emu.IsRunning())
 			{
+				if (UNLIKELY(m_fifo_failed) && !m_fifo_batches.size())
+				{
+					std::rethrow_exception(m_fifo_error);
+				}
+
 				do_internal_task();
 				continue;
 			}
 
-			const u32 cmd = ReadIO32(get);
-			const u32 count = (cmd >> 18) & 0x7ff;
+			// Execute the whole batch
+			const fifo_batch batch = m_fifo_batches[0];
 
-			if ((cmd & RSX_METHOD_OLD_JUMP_CMD_MASK) == RSX_METHOD_OLD_JUMP_CMD)
+			for (u32 pos = m_fifo_ring_read; pos != batch.end; pos++)
 			{
-				u32 offs = cmd & 0x1ffffffc;
-				//LOG_WARNING(RSX, "rsx jump(0x%x) #addr=0x%x, cmd=0x%x, get=0x%x, put=0x%x", offs, m_ioAddress + get, cmd, get, put);
-				ctrl->get = offs;
-				continue;
-			}
-			if ((cmd & RSX_METHOD_NEW_JUMP_CMD_MASK) == RSX_METHOD_NEW_JUMP_CMD)
-			{
-				u32 offs = cmd & 0xfffffffc;
-				//LOG_WARNING(RSX, "rsx jump(0x%x) #addr=0x%x, cmd=0x%x, get=0x%x, put=0x%x", offs, m_ioAddress + get, cmd, get, put);
-				ctrl->get = offs;
-				continue;
-			}
-			if ((cmd & RSX_METHOD_CALL_CMD_MASK) == RSX_METHOD_CALL_CMD)
-			{
-				m_call_stack.push(get + 4);
-				u32 offs = cmd & ~3;
-				//LOG_WARNING(RSX, "rsx call(0x%x) #0x%x - 0x%x", offs, cmd, get);
-				ctrl->get = offs;
-				continue;
+				const u32 reg = m_fifo_ring[pos % fifo_ring_size].first;
+				const u32 value = m_fifo_ring[pos % fifo_ring_size].second;
+
+				//LOG_NOTICE(RSX, "%s(0x%x) = 0x%x", get_method_name(reg).c_str(), reg, value);
+
+				method_registers.decode(reg, value);
+
+				if (capture_current_frame)
+				{
+					frame_debug.command_queue.push_back(std::make_pair(reg, value));
+				}
+
+				if (auto method = methods[reg])
+				{
+					method(this, reg, value);
+				}
 			}
-			if (cmd == RSX_METHOD_RETURN_CMD)
+
+			// Release the executed part of the command buffer
+			ctrl->get = batch.get;
+			m_fifo_ring_read = batch.end;
+			m_fifo_batches.end_pop();
+			m_fifo_thread->notify();
+		}
+	}
+
+	void thread::fifo_walk()
+	{
+		u32 get = ctrl->get;
+		u32 pos = 0;
+
+		// Publish decoded methods up to the current position
+		auto flush = [&]()
+		{
+			while (!m_fifo_batches.try_push(fifo_batch{ pos, get }))
 			{
-				u32 get = m_call_stack.top();
-				m_call_stack.pop();
-				//LOG_WARNING(RSX, "rsx return(0x%x)", get);
-				ctrl->get = get;
-				continue;
+				if (Emu.IsStopped())
+				{
+					return;
+				}
+
+				thread_ctrl::wait_for(1000);
 			}
-			if (cmd == 0) //nop
+
+			this->notify();
+		};
+
+		u32 published_get = get;
+		u32 published_pos = pos;
+
+		// Publish pending methods if there are any
+		auto flush_pending = [&]()
+		{
+			if (published_get != get || published_pos != pos)
 			{
-				ctrl->get = get + 4;
-				continue;
+				flush();
+				published_get = get;
+				published_pos = pos;
+				return true;
 			}
 
-			auto args = vm::ptr<u32>::make((u32)RSXIOMem.RealAddr(get + 4));
+			return false;
+		};
 
-			u32 first_cmd = (cmd & 0xfffc) >> 2;
+		// Control flow commands since the last decoded method (jump loops used as a wait)
+		u32 jumps = 0;
 
-			if (cmd & 0x3)
+		// Execute pending methods before following the command, back off if the walker is spinning
+		auto before_jump = [&]()
+		{
+			if (!flush_pending() && ++jumps > 16)
 			{
-				LOG_WARNING(RSX, "unaligned command: %s (0x%x from 0x%x)", get_method_name(first_cmd).c_str(), first_cmd, cmd & 0xffff);
+				thread_ctrl::wait_for(100);
 			}
+		};
 
-			for (u32 i = 0; i < count; i++)
+		try
+		{
+			while (!Emu.IsStopped())
 			{
-				u32 reg = ((cmd & RSX_METHOD_NON_INCREMENT_CMD_MASK) == RSX_METHOD_NON_INCREMENT_CMD) ? first_cmd : first_cmd + i;
-				u32 value = args[i];
+				const u32 put = ctrl->put;
 
-				//LOG_NOTICE(RSX, "%s(0x%x) = 0x%x", get_method_name(reg).c_str(), reg, value);
+				if (put == get || !Emu.IsRunning())
+				{
+					// Caught up: publish the rest even if it doesn't end with a draw call
+					if (flush_pending())
+					{
+						continue;
+					}
 
-				method_registers.decode(reg, value);
+					thread_ctrl::wait_for(1000);
+					continue;
+				}
 
-				if (capture_current_frame)
+				const u32 cmd = ReadIO32(get);
+				const u32 count = (cmd >> 18) & 0x7ff;
+
+				if ((cmd & RSX_METHOD_OLD_JUMP_CMD_MASK) == RSX_METHOD_OLD_JUMP_CMD)
 				{
-					frame_debug.command_queue.push_back(std::make_pair(reg, value));
+					u32 offs = cmd & 0x1ffffffc;
+					//LOG_WARNING(RSX, "rsx jump(0x%x) #addr=0x%x, cmd=0x%x, get=0x%x, put=0x%x", offs, m_ioAddress + get, cmd, get, put);
+					before_jump();
+					get = offs;
+					continue;
+				}
+				if ((cmd & RSX_METHOD_NEW_JUMP_CMD_MASK) == RSX_METHOD_NEW_JUMP_CMD)
+				{
+					u32 offs = cmd & 0xfffffffc;
+					//LOG_WARNING(RSX, "rsx jump(0x%x) #addr=0x%x, cmd=0x%x, get=0x%x, put=0x%x", offs, m_ioAddress + get, cmd, get, put);
+					before_jump();
+					get = offs;
+					continue;
+				}
+				if ((cmd & RSX_METHOD_CALL_CMD_MASK) == RSX_METHOD_CALL_CMD)
+				{
+					before_jump();
+					m_call_stack.push(get + 4);
+					u32 offs = cmd & ~3;
+					//LOG_WARNING(RSX, "rsx call(0x%x) #0x%x - 0x%x", offs, cmd, get);
+					get = offs;
+					continue;
+				}
+				if (cmd == RSX_METHOD_RETURN_CMD)
+				{
+					//LOG_WARNING(RSX, "rsx return(0x%x)", m_call_stack.top());
+					before_jump();
+					get = m_call_stack.top();
+					m_call_stack.pop();
+					continue;
+				}
+				if (cmd == 0) //nop
+				{
+					get += 4;
+					continue;
 				}
 
-				if (auto method = methods[reg])
+				auto args = vm::ptr<u32>::make((u32)RSXIOMem.RealAddr(get + 4));
+
+				u32 first_cmd = (cmd & 0xfffc) >> 2;
+
+				if (cmd & 0x3)
 				{
-					method(this, reg, value);
+					LOG_WARNING(RSX, "unaligned command: %s (0x%x from 0x%x)", get_method_name(first_cmd).c_str(), first_cmd, cmd & 0xffff);
 				}
-			}
 
-			ctrl->get = get + (count + 1) * 4;
+				// Wait for space in the ring
+				while (pos + count - m_fifo_ring_read > fifo_ring_size)
+				{
+					if (Emu.IsStopped())
+					{
+						return;
+					}
+
+					thread_ctrl::wait_for(1000);
+				}
+
+				const bool non_increment = (cmd & RSX_METHOD_NON_INCREMENT_CMD_MASK) == RSX_METHOD_NON_INCREMENT_CMD;
+				bool draw_end = false;
+				jumps = 0;
+
+				// Methods which may block the RSX thread (the guest may wait for the get pointer meanwhile)
+				const auto has_method = [&](u32 reg)
+				{
+					return non_increment ? first_cmd == reg : reg >= first_cmd && reg - first_cmd < count;
+				};
+
+				const bool blocking = count && (has_method(NV406E_SEMAPHORE_ACQUIRE) || has_method(GCM_FLIP_COMMAND));
+
+				if (blocking)
+				{
+					// Release the preceding commands before the blocking method is executed
+					flush_pending();
+				}
+
+				for (u32 i = 0; i < count; i++)
+				{
+					const u32 reg = non_increment ? first_cmd : first_cmd + i;
+					const u32 value = args[i];
+
+					m_fifo_ring[pos++ % fifo_ring_size] = std::make_pair(reg, value);
+
+					if (reg == NV4097_SET_BEGIN_END && value == 0)
+					{
+						draw_end = true;
+					}
+				}
+
+				get += (count + 1) * 4;
+
+				// Cut the batch at draw call boundaries, after blocking methods (or if the ring is half full)
+				if (draw_end || blocking || pos - published_pos >= fifo_ring_size / 2)
+				{
+					flush();
+					published_get = get;
+					published_pos = pos;
+				}
+			}
+		}
+		catch (...)
+		{
+			// Execute the methods decoded before the error
+			flush_pending();
+			throw;
 		}
 	}
 
 	void thread::on_exit()
 	{
+		if (m_fifo_thread)
+		{
+			m_fifo_thread->join();
+			m_fifo_thread.reset();
+		}
+
 		if (m_vblank_thread)
 		{
 			m_vblank_thread->join();
@@ -694,7 +862,8 @@ namespace rsx
 	{
 		if (m_internal_tasks.empty())
 		{
-			std::this_thread::sleep_for(1ms);
+			// Woken up by the FIFO thread
+			thread_ctrl::wait_for(1000);
 		}
 		else
 		{
@@ -14,6 +14,7 @@
 #include <Utilities/GSL.h>
 
 #include "Utilities/Thread.h"
+#include "Utilities/lockless.h"
 #include "Utilities/Timer.h"
 #include "Utilities/geometry.h"
 #include "rsx_trace.h"
@@ -162,11 +163,36 @@ namespace rsx
 		std::vector<u32> inline_vertex_array;
 	};
 
+	/**
+	 * Batch of pre-decoded FIFO methods, ends at a draw call boundary or where the FIFO walker caught up with put
+	 */
+	struct fifo_batch
+	{
+		u32 end; // Position in the method ring after the last method of the batch
+		u32 get; // FIFO get pointer after the batch
+	};
+
 	class thread : public named_thread
 	{
 		std::shared_ptr<thread_ctrl> m_vblank_thread;
+		std::shared_ptr<thread_ctrl> m_fifo_thread;
+
+		static const u32 fifo_ring_size = 0x10000;
+
+		// Decoded method register writes <reg, value> (producer: FIFO thread, consumer: RSX thread)
+		std::unique_ptr<std::pair<u32, u32>[]> m_fifo_ring;
+		atomic_t<u32> m_fifo_ring_read{ 0 };
+		lf_spsc<fifo_batch, 1024> m_fifo_batches;
+
+		// Exception thrown by the FIFO walker (rethrown by the RSX thread after the pending batches)
+		std::exception_ptr m_fifo_error;
+		atomic_t<bool> m_fifo_failed{ false };
+
+		// Walk the command buffer (jumps, calls and returns) and decode methods into the ring
+		void fifo_walk();
 
 	protected:
+		// Call stack of the FIFO walker
 		std::stack<u32> m_call_stack;
 
 	public:
@@ -200,5 +200,121 @@ namespace rsx
 
 			return std::make_pair(min, max);
 		}
+
+		std::pair<u32, u32> get_locked_range() const
+		{
+			return std::make_pair(locked_address_base, locked_address_range);
+		}
+	};
+
+	/**
+	 * Address range index for cached sections, identified by their slot number in the owning container.
+	 * Ranges are bucketed into 64k blocks, so an overlap query only visits the sections sharing a block with it.
+	 */
+	class section_index
+	{
+		static const u32 block_shift = 16;
+
+		std::unordered_map<u32, std::vector<u32>> m_blocks;
+
+		// Indexed range <base, length> of each slot (length 0 if not indexed)
+		std::vector<std::pair<u32, u32>> m_ranges;
+
+		template <typename F>
+		static void for_each_block(u32 base, u32 length, F&& func)
+		{
+			const u32 last = static_cast<u32>((u64{base} + length - 1) >> block_shift);
+
+			for (u32 block = base >> block_shift; block <= last; block++)
+			{
+				func(block);
+			}
+		}
+
+	public:
+
+		void erase(u32 id)
+		{
+			if (id >= m_ranges.size() || !m_ranges[id].second)
+				return;
+
+			for_each_block(m_ranges[id].first, m_ranges[id].second, [&](u32 block)
+			{
+				auto found = m_blocks.find(block);
+				auto &ids = found->second;
+
+				ids.erase(std::find(ids.begin(), ids.end(), id));
+
+				if (ids.empty())
+					m_blocks.erase(found);
+			});
+
+			m_ranges[id].second = 0;
+		}
+
+		//Add or move the section (empty ranges are indexed as a single byte so that base address lookups still work)
+		void update(u32 id, std::pair<u32, u32> range)
+		{
+			range.second = std::max<u32>(range.second, 1);
+
+			if (id < m_ranges.size() && m_ranges[id] == range)
+				return;
+
+			erase(id);
+
+			if (id >= m_ranges.size())
+				m_ranges.resize(id + 1);
+
+			for_each_block(range.first, range.second, [&](u32 block)
+			{
+				m_blocks[block].push_back(id);
+			});
+
+			m_ranges[id] = range;
+		}
+
+		void clear()
+		{
+			m_blocks.clear();
+			m_ranges.clear();
+		}
+
+		/**
+		 * Call func(id) for each slot overlapping the range <base, base + length>, stops if func returns false
+		 * Each slot is visited once (in the block containing the start of the intersection), func must not modify the index
+		 */
+		template <typename F>
+		bool for_each(u32 base, u32 length, F&& func) const
+		{
+			if (!length)
+				return true;
+
+			const u64 limit = u64{base} + length;
+			const u32 last = static_cast<u32>((limit - 1) >> block_shift);
+
+			for (u32 block = base >> block_shift; block <= last; block++)
+			{
+				auto found = m_blocks.find(block);
+
+				if (found == m_blocks.end())
+					continue;
+
+				for (u32 id : found->second)
+				{
+					const auto &range = m_ranges[id];
+
+					if (range.first >= limit || base >= u64{range.first} + range.second)
+						continue;
+
+					if ((std::max(base, range.first) >> block_shift) != block)
+						continue;
+
+					if (!func(id))
+						return false;
+				}
+			}
+
+			return true;
+		}
 	};
 }
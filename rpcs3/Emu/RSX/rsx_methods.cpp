@@ -4,8 +4,10 @@
 #include "RSXThread.h"
 #include "Emu/Memory/Memory.h"
 #include "Emu/System.h"
+#include "Emu/IdManager.h"
 #include "rsx_utils.h"
 #include "rsx_decode.h"
+#include "Common/software_blit.h"
 #include "Emu/Cell/PPUCallback.h"
 
 #include <sstream>
@@ -506,7 +508,7 @@ namespace rsx
 				LOG_ERROR(RSX, "NV3089_IMAGE_IN_SIZE: unknown src_color_format (%d)", (u8)src_color_format);
 			}
 
-			std::unique_ptr<u8[]> temp1, temp2, sw_temp;
+			const auto blitter = fxm::get_always<software_blitter>();
 
 			AVPixelFormat in_format = (src_color_format == rsx::blit_engine::transfer_source_format::r5g6b5) ? AV_PIX_FMT_RGB565BE : AV_PIX_FMT_ARGB;
 			AVPixelFormat out_format = (dst_color_format == rsx::blit_engine::transfer_destination_format::r5g6b5) ? AV_PIX_FMT_RGB565BE : AV_PIX_FMT_ARGB;
@@ -551,10 +553,10 @@ namespace rsx
 					{
 						if (need_convert)
 						{
-							convert_scale_image(temp1, out_format, convert_w, convert_h, out_pitch,
+							const u8* temp1 = blitter->scale_to_scratch(0, out_format, convert_w, convert_h, out_pitch,
 								pixels_src, in_format, in_w, in_h, in_pitch, slice_h, in_inter == blit_engine::transfer_interpolator::foh);
 
-							clip_image(pixels_dst, temp1.get(), clip_x, clip_y, clip_w, clip_h, out_bpp, out_pitch, out_pitch);
+							clip_image(pixels_dst, temp1, clip_x, clip_y, clip_w, clip_h, out_bpp, out_pitch, out_pitch);
 						}
 						else
 						{
@@ -563,7 +565,7 @@ namespace rsx
 					}
 					else
 					{
-						convert_scale_image(pixels_dst, out_format, out_w, out_h, out_pitch,
+						blitter->scale_image(pixels_dst, out_format, out_w, out_h, out_pitch,
 							pixels_src, in_format, in_w, in_h, in_pitch, slice_h, in_inter == blit_engine::transfer_interpolator::foh);
 					}
 				}
@@ -589,14 +591,18 @@ namespace rsx
 			{
 				if (need_convert || need_clip)
 				{
+					u8* temp2;
+
 					if (need_clip)
 					{
+						temp2 = blitter->get_scratch(1, clip_h * out_pitch);
+
 						if (need_convert)
 						{
-							convert_scale_image(temp1, out_format, convert_w, convert_h, out_pitch,
+							const u8* temp1 = blitter->scale_to_scratch(0, out_format, convert_w, convert_h, out_pitch,
 								pixels_src, in_format, in_w, in_h, in_pitch, slice_h, in_inter == blit_engine::transfer_interpolator::foh);
 
-							clip_image(temp2, temp1.get(), clip_x, clip_y, clip_w, clip_h, out_bpp, out_pitch, out_pitch);
+							clip_image(temp2, temp1, clip_x, clip_y, clip_w, clip_h, out_bpp, out_pitch, out_pitch);
 						}
 						else
 						{
@@ -605,11 +611,11 @@ namespace rsx
 					}
 					else
 					{
-						convert_scale_image(temp2, out_format, out_w, out_h, out_pitch,
+						temp2 = blitter->scale_to_scratch(1, out_format, out_w, out_h, out_pitch,
 							pixels_src, in_format, in_w, in_h, in_pitch, clip_h, in_inter == blit_engine::transfer_interpolator::foh);
 					}
 
-					pixels_src = temp2.get();
+					pixels_src = temp2;
 				}
 
 				u8 sw_width_log2 = method_registers.nv309e_sw_width_log2();
@@ -622,30 +628,28 @@ namespace rsx
 				u16 sw_width = 1 << sw_width_log2;
 				u16 sw_height = 1 << sw_height_log2;
 
-				temp2.reset(new u8[out_bpp * sw_width * sw_height]);
-
 				u8* linear_pixels = pixels_src;
-				u8* swizzled_pixels = temp2.get();
+				u8* swizzled_pixels = blitter->get_scratch(0, out_bpp * sw_width * sw_height);
 
 				// Check and pad texture out if we are given non square texture for swizzle to be correct
 				if (sw_width != out_w || sw_height != out_h)
 				{
-					sw_temp.reset(new u8[out_bpp * sw_width * sw_height]);
+					u8* sw_temp = blitter->get_scratch(2, out_bpp * sw_width * sw_height);
 
 					switch (out_bpp)
 					{
 					case 1:
-						pad_texture<u8>(linear_pixels, sw_temp.get(), out_w, out_h, sw_width, sw_height);
+						pad_texture<u8>(linear_pixels, sw_temp, out_w, out_h, sw_width, sw_height);
 						break;
 					case 2:
-						pad_texture<u16>(linear_pixels, sw_temp.get(), out_w, out_h, sw_width, sw_height);
+						pad_texture<u16>(linear_pixels, sw_temp, out_w, out_h, sw_width, sw_height);
 						break;
 					case 4:
-						pad_texture<u32>(linear_pixels, sw_temp.get(), out_w, out_h, sw_width, sw_height);
+						pad_texture<u32>(linear_pixels, sw_temp, out_w, out_h, sw_width, sw_height);
 						break;
 					}
 
-					linear_pixels = sw_temp.get();
+					linear_pixels = sw_temp;
 				}
 
 				switch (out_bpp)
@@ -106,6 +106,78 @@ namespace rsx
 		}
 	}
 
+	/**
+	* Convert swizzled image directly to linear image with the given row pitch (in elements), U is converted to T
+	* Addressing is identical to convert_linear_swizzle (input_is_swizzled = true), but no intermediate buffer is required.
+	* 4x4 tiles (16 contiguous elements in the swizzled image) are copied at once when dimensions allow it.
+	*/
+	template<typename T, typename U>
+	void convert_swizzled_to_linear(T* output_pixels, const U* input_pixels, u16 width, u16 height, u32 dst_pitch)
+	{
+		const u32 log2width = ceil_log2(width);
+		const u32 log2height = ceil_log2(height);
+
+		// Interleaved bits (x bits are even, y bits are odd), bits above are used by the larger dimension
+		const u32 limit = std::min(log2width, log2height);
+		const u32 limit_mask = 1u << (limit << 1);
+		const u32 x_mask = 0x55555555 | ~(limit_mask - 1);
+
+		// Offset of the first pixel of the row
+		const auto get_row_offset = [&](u32 y)
+		{
+			u32 offset = (y >> limit) << (limit << 1);
+
+			for (u32 i = 0; i < limit; i++)
+			{
+				offset |= ((y >> i) & 1) << (i * 2 + 1);
+			}
+
+			return offset;
+		};
+
+		if (limit >= 2 && width % 4 == 0 && height % 4 == 0)
+		{
+			for (u32 y = 0; y < height; y += 4)
+			{
+				const U* src = input_pixels + get_row_offset(y);
+				T* dst = output_pixels + y * dst_pitch;
+
+				for (u32 x = 0, offs_x = 0; x < width; x += 4)
+				{
+					// Morton order of the tile: rows are {0, 1, 4, 5}, {2, 3, 6, 7}, {8, 9, 12, 13}, {10, 11, 14, 15}
+					const U* tile = src + offs_x;
+
+					for (u32 row = 0; row < 4; row++)
+					{
+						const U* in = tile + (row & 1) * 2 + (row & 2) * 4;
+						T* out = dst + row * dst_pitch + x;
+						out[0] = in[0];
+						out[1] = in[1];
+						out[2] = in[4];
+						out[3] = in[5];
+					}
+
+					// Increment x by 4 (x bit 2 is stored in bit 4)
+					offs_x = ((offs_x | ~x_mask) + 0x10) & x_mask;
+				}
+			}
+
+			return;
+		}
+
+		for (u32 y = 0; y < height; y++)
+		{
+			const U* src = input_pixels + get_row_offset(y);
+			T* dst = output_pixels + y * dst_pitch;
+
+			for (u32 x = 0, offs_x = 0; x < width; x++)
+			{
+				dst[x] = src[offs_x];
+				offs_x = (offs_x - x_mask) & x_mask;
+			}
+		}
+	}
+
 	void convert_scale_image(u8 *dst, AVPixelFormat dst_format, int dst_width, int dst_height, int dst_pitch,
 		const u8 *src, AVPixelFormat src_format, int src_width, int src_height, int src_pitch, int src_slice_h, bool bilinear);
 